@@ -0,0 +1,604 @@
+/**
+ * @file bench.c
+ * @author a24869
+ * @brief Benchmark das operações principais sobre grelhas sintéticas.
+ *
+ * Gera uma grelha N×M com a densidade de antenas e a distribuição de frequências
+ * indicadas, e mede:
+ * - A leitura do ficheiro de texto (readGraphFromFile) e a releitura de uma versão do
+ *   ficheiro com poucas antenas retiradas (reloadGraphFromFile).
+ * - A construção do grafo a partir das antenas em memória (addVertex), nos modos explícito,
+ *   implícito e por alcance, e a construção paralela por frequência (buildGraphParallel).
+ * - DFS e BFS a partir de um vértice de cada frequência, também repetidas através do QueryCache.
+ * - Caminho mais curto (BFS bidirecional e A*) entre o primeiro e o último membro
+ *   de cada frequência.
+ * - As intersecções entre as duas frequências mais comuns.
+ * - As posições afetadas pelo efeito nefasto de todos os pares (computeInterference).
+ * - A escrita e leitura do ficheiro binário.
+ * - A conversão para o ficheiro de blocos e a BFS sobre ele com memória limitada.
+ *
+ * Os resultados são escritos em JSON (ns por operação e pico de memória residente),
+ * para serem comparados entre versões.
+ *
+ * Utilização: graphBench [--rows N] [--cols M] [--density D] [--frequencies K]
+ *                        [--skew S] [--seed X] [--repeat R] [--radius D] [--nearest N]
+ *                        [--output ficheiro]
+ *
+ * @date 2025-05-08
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "lib/functions.h"
+
+/** Carácteres usados como frequências, por ordem de frequência esperada */
+static const char FREQUENCY_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+/** Número máximo de resultados guardados */
+#define MAX_RESULTS 32
+
+/**
+ * @struct BenchOptions
+ * @brief Parâmetros da grelha gerada e das medições.
+ */
+typedef struct BenchOptions{
+    int rows;
+    int cols;
+    double density; // Probabilidade de cada célula ter uma antena
+    int frequencies; // Número de frequências diferentes
+    double skew; // Expoente da distribuição das frequências (0 = uniforme)
+    unsigned long long seed;
+    int repeat; // Repetições de cada medição
+    int radius; // Raio das ligações do modo por alcance
+    int nearest; // Limite de vizinhos do modo por alcance (0 = sem limite)
+    const char *output; // Ficheiro JSON, ou NULL para stdout
+} BenchOptions;
+
+/**
+ * @struct BenchResult
+ * @brief Resultado de uma medição.
+ */
+typedef struct BenchResult{
+    const char *name;
+    long long iterations;
+    long long totalNs;
+    long long items; // Vértices, ligações ou pares tratados pela medição (0 se não se aplica)
+} BenchResult;
+
+static BenchResult results[MAX_RESULTS];
+static int resultCount = 0;
+
+/** @brief Tempo monotónico atual em nanossegundos */
+static long long nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/** @brief Guarda o resultado de uma medição */
+static void record(const char *name, long long iterations, long long totalNs, long long items) {
+    if (resultCount == MAX_RESULTS) return;
+    results[resultCount].name = name;
+    results[resultCount].iterations = iterations;
+    results[resultCount].totalNs = totalNs;
+    results[resultCount].items = items;
+    resultCount++;
+}
+
+/** @brief Gerador pseudo-aleatório xorshift64*, igual em todas as plataformas */
+static unsigned long long nextRandom(unsigned long long *state) {
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/** @brief Número pseudo-aleatório em [0, 1) */
+static double nextUnit(unsigned long long *state) {
+    return (double)(nextRandom(state) >> 11) / (double)(1ULL << 53);
+}
+
+/**
+ * @brief Gera a grelha sintética num ficheiro de texto e devolve as antenas geradas
+ *
+ * A frequência i (a partir de 0) tem peso 1 / (i + 1)^skew.
+ *
+ * @param opt Parâmetros da grelha
+ * @param filename Ficheiro a criar
+ * @param count Número de antenas geradas
+ * @return AntennaCell* Array com as antenas, pela ordem do ficheiro, ou NULL em caso de erro
+ */
+static AntennaCell *generateGrid(const BenchOptions *opt, const char *filename, int *count) {
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) return NULL;
+
+    // Distribuição acumulada das frequências
+    double cumulative[sizeof(FREQUENCY_ALPHABET)];
+    double total = 0;
+    for (int i = 0; i < opt->frequencies; i++) {
+        total += 1.0 / pow(i + 1, opt->skew);
+        cumulative[i] = total;
+    }
+
+    int capacity = 1024;
+    AntennaCell *cells = (AntennaCell*)malloc(sizeof(AntennaCell) * capacity);
+    char *line = (char*)malloc((size_t)opt->cols * 2 + 1);
+    if (cells == NULL || line == NULL) {
+        free(cells);
+        free(line);
+        fclose(f);
+        return NULL;
+    }
+
+    unsigned long long state = opt->seed ? opt->seed : 1;
+    *count = 0;
+    for (int x = 0; x < opt->rows; x++) {
+        for (int y = 0; y < opt->cols; y++) {
+            char c = '.';
+            if (nextUnit(&state) < opt->density) {
+                double r = nextUnit(&state) * total;
+                int i = 0;
+                while (i < opt->frequencies - 1 && cumulative[i] <= r) i++;
+                c = FREQUENCY_ALPHABET[i];
+
+                if (*count == capacity) {
+                    capacity *= 2;
+                    AntennaCell *grown = (AntennaCell*)realloc(cells, sizeof(AntennaCell) * capacity);
+                    if (grown == NULL) {
+                        free(cells);
+                        free(line);
+                        fclose(f);
+                        return NULL;
+                    }
+                    cells = grown;
+                }
+                cells[*count].x = x;
+                cells[*count].y = y;
+                cells[*count].frequency = c;
+                (*count)++;
+            }
+            line[y * 2] = c;
+            line[y * 2 + 1] = ' ';
+        }
+        line[opt->cols * 2 - 1] = '\n';
+        fwrite(line, 1, (size_t)opt->cols * 2, f);
+    }
+    free(line);
+    fclose(f);
+    return cells;
+}
+
+/** @brief Conta os vértices entregues por uma pesquisa */
+static void countVertex(Vertex *v, void *userData) {
+    (void)v;
+    (*(long long*)userData)++;
+}
+
+/** @brief Conta os pares entregues pelo listIntersectionsVisit */
+static void countPair(Vertex *a, Vertex *b, void *userData) {
+    (void)a;
+    (void)b;
+    (*(long long*)userData)++;
+}
+
+/** @brief Constrói um grafo a partir das antenas em memória */
+static Graph *buildGraph(const AntennaCell *cells, int count, GraphMode mode) {
+    Graph *g = createGraphWithMode(mode);
+    if (g == NULL) return NULL;
+    for (int i = 0; i < count; i++) {
+        addVertex(g, cells[i].x, cells[i].y, cells[i].frequency);
+    }
+    return g;
+}
+
+/** @brief Conta as ligações do grafo (cada ligação conta nos dois sentidos) */
+static long long countEdges(Graph *g) {
+    long long edges = 0;
+    for (Vertex *v = g->vertices; v != NULL; v = v->next) {
+        NeighborCursor c;
+        beginNeighbors(g, v, &c);
+        while (nextNeighbor(g, v, &c) != NULL) edges++;
+    }
+    return edges;
+}
+
+/** @brief Mede a leitura do ficheiro de texto */
+static void benchReadText(const BenchOptions *opt, const char *filename) {
+    long long start = nowNs();
+    long long vertices = 0;
+    for (int r = 0; r < opt->repeat; r++) {
+        Graph *g = readGraphFromFile(filename);
+        if (g != NULL) vertices += g->vertexCount;
+        freeGraph(g);
+    }
+    record("read_text", opt->repeat, nowNs() - start, vertices);
+}
+
+/** Antenas retiradas do ficheiro alterado usado na medição do reloadGraphFromFile */
+#define BENCH_RELOAD_EDITS 8
+
+/**
+ * @brief Escreve a grelha sem as primeiras antenas (uma por cada BENCH_RELOAD_EDITS)
+ * 
+ * @param opt Parâmetros da grelha
+ * @param cells Antenas da grelha, por ordem de linha e coluna
+ * @param count Número de antenas
+ * @param filename Ficheiro a criar
+ * @return true se o ficheiro foi escrito
+ */
+static bool writeEditedGrid(const BenchOptions *opt, const AntennaCell *cells, int count, const char *filename) {
+    FILE *f = fopen(filename, "w");
+    char *line = (char*)malloc((size_t)opt->cols + 2);
+    if (f == NULL || line == NULL) {
+        if (f != NULL) fclose(f);
+        free(line);
+        return false;
+    }
+    int next = 0;
+    for (int x = 0; x < opt->rows; x++) {
+        memset(line, '.', opt->cols);
+        line[opt->cols] = '\n';
+        line[opt->cols + 1] = '\0';
+        for (; next < count && cells[next].x == x; next++) {
+            if (next >= BENCH_RELOAD_EDITS) line[cells[next].y] = cells[next].frequency;
+        }
+        fputs(line, f);
+    }
+    free(line);
+    return fclose(f) == 0;
+}
+
+/** @brief Mede a releitura alternada do ficheiro alterado e do original sobre o mesmo grafo */
+static void benchReload(const BenchOptions *opt, const AntennaCell *cells, int count,
+                        const char *textFile, const char *editedFile) {
+    if (!writeEditedGrid(opt, cells, count, editedFile)) return;
+    Graph *g = readGraphFromFile(textFile);
+    if (g == NULL) return;
+
+    long long edits = 0;
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        for (int i = 0; i < 2; i++) {
+            ReloadStats stats;
+            if (reloadGraphFromFile(g, i == 0 ? editedFile : textFile, &stats)) {
+                edits += stats.added + stats.removed + stats.changed;
+            }
+        }
+    }
+    record("reload", 2LL * opt->repeat, nowNs() - start, edits);
+    freeGraph(g);
+}
+
+/** @brief Mede a construção do grafo a partir das antenas em memória */
+static void benchBuild(const BenchOptions *opt, const AntennaCell *cells, int count, GraphMode mode, const char *name) {
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        freeGraph(buildGraph(cells, count, mode));
+    }
+    record(name, opt->repeat, nowNs() - start, (long long)count * opt->repeat);
+}
+
+/** @brief Mede a construção no modo por alcance e conta as ligações criadas */
+static long long benchBuildRanged(const BenchOptions *opt, const AntennaCell *cells, int count) {
+    long long edges = 0;
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        Graph *g = createGraphWithRange(opt->radius, opt->nearest);
+        if (g == NULL) return 0;
+        for (int i = 0; i < count; i++) {
+            addVertex(g, cells[i].x, cells[i].y, cells[i].frequency);
+        }
+        if (r == 0) edges = countEdges(g) / 2;
+        freeGraph(g);
+    }
+    record("build_ranged", opt->repeat, nowNs() - start, (long long)count * opt->repeat);
+    return edges;
+}
+
+/** @brief Mede a construção paralela por frequência, com todos os processadores */
+static void benchBuildParallel(const BenchOptions *opt, const AntennaCell *cells, int count) {
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        freeGraph(buildGraphParallel(cells, count, GRAPH_EXPLICIT, 0));
+    }
+    record("build_parallel", opt->repeat, nowNs() - start, (long long)count * opt->repeat);
+}
+
+/** @brief Mede DFS e BFS a partir do membro mais antigo de cada frequência */
+static void benchTraversals(const BenchOptions *opt, Graph *g) {
+    TraversalContext *ctx = createTraversalContext();
+    if (ctx == NULL) return;
+
+    for (int kind = 0; kind < 2; kind++) {
+        long long visited = 0, iterations = 0;
+        long long start = nowNs();
+        for (int r = 0; r < opt->repeat; r++) {
+            for (int f = 0; f < FREQUENCY_COUNT; f++) {
+                Vertex *v = g->frequencyHead[f];
+                if (v == NULL) continue;
+                if (kind == 0) {
+                    depthFirstSearchVisit(g, ctx, v->x, v->y, v->frequency, countVertex, &visited);
+                } else {
+                    breadthFirstSearchVisit(g, ctx, v->x, v->y, v->frequency, countVertex, &visited);
+                }
+                iterations++;
+            }
+        }
+        record(kind == 0 ? "dfs" : "bfs", iterations, nowNs() - start, visited);
+    }
+    freeTraversalContext(ctx);
+}
+
+/** @brief Mede as mesmas BFS repetidas através do QueryCache (só a primeira repetição as calcula) */
+static void benchQueryCache(const BenchOptions *opt, Graph *g) {
+    QueryCache *cache = createQueryCache(g, FREQUENCY_COUNT);
+    if (cache == NULL) return;
+
+    long long visited = 0, iterations = 0;
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        for (int f = 0; f < FREQUENCY_COUNT; f++) {
+            Vertex *v = g->frequencyHead[f];
+            if (v == NULL) continue;
+            Query q = { QUERY_BFS, v->x, v->y, 0, 0, v->frequency, 0, 0, 0 };
+            const QueryResult *result = cachedQuery(cache, &q);
+            if (result != NULL) visited += result->vertexCount;
+            iterations++;
+        }
+    }
+    record("bfs_cached", iterations, nowNs() - start, visited);
+    freeQueryCache(cache);
+}
+
+/** @brief Mede o caminho mais curto entre o membro mais antigo e o mais recente de cada frequência */
+static void benchShortestPaths(const BenchOptions *opt, Graph *g) {
+    TraversalContext *ctx = createTraversalContext();
+    if (ctx == NULL) return;
+
+    for (int weighted = 0; weighted < 2; weighted++) {
+        long long vertices = 0, iterations = 0;
+        long long start = nowNs();
+        for (int r = 0; r < opt->repeat; r++) {
+            for (int f = 0; f < FREQUENCY_COUNT; f++) {
+                Vertex *a = g->frequencyHead[f];
+                Vertex *b = g->frequencyTail[f];
+                if (a == NULL || a == b) continue;
+                int length = weighted
+                    ? shortestPathWeighted(g, ctx, a->x, a->y, b->x, b->y, a->frequency, NULL, 0, NULL)
+                    : shortestPath(g, ctx, a->x, a->y, b->x, b->y, a->frequency, NULL, 0);
+                if (length > 0) vertices += length;
+                iterations++;
+            }
+        }
+        record(weighted ? "shortest_path_astar" : "shortest_path", iterations, nowNs() - start, vertices);
+    }
+    freeTraversalContext(ctx);
+}
+
+/** @brief Mede a BFS por bitsets sobre o grafo compacto, com os mesmos vértices iniciais */
+static void benchBitsetTraversal(const BenchOptions *opt, Graph *g) {
+    CsrGraph *csr = buildCsrGraph(g);
+    if (csr == NULL) return;
+
+    long long visited = 0, iterations = 0;
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        for (int f = 0; f < FREQUENCY_COUNT; f++) {
+            Vertex *v = g->frequencyHead[f];
+            if (v == NULL) continue;
+            int reached = csrBreadthFirstDistances(csr, v->x, v->y, v->frequency, NULL);
+            if (reached > 0) visited += reached;
+            iterations++;
+        }
+    }
+    record("bfs_bitset", iterations, nowNs() - start, visited);
+    freeCsrGraph(csr);
+}
+
+/** @brief Mede as intersecções entre as duas frequências com mais membros */
+static void benchIntersections(const BenchOptions *opt, Graph *g) {
+    int first = -1, second = -1;
+    for (int f = 0; f < FREQUENCY_COUNT; f++) {
+        if (g->frequencyCount[f] == 0) continue;
+        if (first < 0 || g->frequencyCount[f] > g->frequencyCount[first]) {
+            second = first;
+            first = f;
+        } else if (second < 0 || g->frequencyCount[f] > g->frequencyCount[second]) {
+            second = f;
+        }
+    }
+    if (second < 0) return;
+
+    long long pairs = 0;
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        listIntersectionsVisit(g, (char)first, (char)second, countPair, &pairs);
+    }
+    record("intersections", opt->repeat, nowNs() - start, pairs);
+}
+
+/** @brief Mede o cálculo das posições afetadas pelo efeito nefasto */
+static void benchInterference(const BenchOptions *opt, Graph *g) {
+    long long locations = 0;
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        InterferenceMap *map = computeInterference(g, 0);
+        if (map != NULL) locations += map->count;
+        freeInterferenceMap(map);
+    }
+    record("interference", opt->repeat, nowNs() - start, locations);
+}
+
+/** @brief Mede a escrita e a leitura do ficheiro binário */
+static void benchBinary(const BenchOptions *opt, Graph *g, const char *filename) {
+    long long start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        writeGraphToBinary(filename, g);
+    }
+    record("binary_write", opt->repeat, nowNs() - start, (long long)g->vertexCount * opt->repeat);
+
+    long long vertices = 0;
+    start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        Graph *copy = readGraphFromBinary(filename);
+        if (copy != NULL) vertices += copy->vertexCount;
+        freeGraph(copy);
+    }
+    record("binary_read", opt->repeat, nowNs() - start, vertices);
+}
+
+/** Lado dos blocos e memória máxima dos blocos carregados na medição do grafo em blocos */
+#define BENCH_TILE_SIZE 64
+#define BENCH_TILE_BUDGET (1 << 20)
+
+/** @brief Conta as antenas visitadas por uma pesquisa no grafo em blocos */
+static void countCell(const AntennaCell *cell, void *userData) {
+    (void)cell;
+    (*(long long*)userData)++;
+}
+
+/** @brief Mede a conversão para o ficheiro de blocos e a BFS sobre ele, a partir de um vértice de cada frequência */
+static void benchTiled(const BenchOptions *opt, Graph *g, const char *textFile, const char *tiledFile) {
+    long long start = nowNs();
+    bool written = true;
+    for (int r = 0; r < opt->repeat && written; r++) {
+        written = writeTiledGraph(textFile, tiledFile, BENCH_TILE_SIZE);
+    }
+    if (!written) return;
+    record("tiled_write", opt->repeat, nowNs() - start, (long long)g->vertexCount * opt->repeat);
+
+    TiledGraph *t = openTiledGraph(tiledFile, BENCH_TILE_BUDGET, opt->radius);
+    if (t == NULL) return;
+    long long visited = 0, iterations = 0;
+    start = nowNs();
+    for (int r = 0; r < opt->repeat; r++) {
+        for (int f = 0; f < FREQUENCY_COUNT; f++) {
+            Vertex *v = g->frequencyHead[f];
+            if (v == NULL) continue;
+            tiledBreadthFirstSearch(t, v->x, v->y, v->frequency, countCell, &visited);
+            iterations++;
+        }
+    }
+    record("tiled_bfs", iterations, nowNs() - start, visited);
+    closeTiledGraph(t);
+}
+
+/** @brief Escreve os resultados em JSON */
+static void writeJson(FILE *out, const BenchOptions *opt, int antennas, long long edges, long long rangedEdges) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"grid\": {\"rows\": %d, \"cols\": %d, \"density\": %g, \"frequencies\": %d, \"skew\": %g, \"seed\": %llu},\n",
+            opt->rows, opt->cols, opt->density, opt->frequencies, opt->skew, opt->seed);
+    fprintf(out, "  \"antennas\": %d,\n", antennas);
+    fprintf(out, "  \"edges\": %lld,\n", edges);
+    fprintf(out, "  \"ranged\": {\"radius\": %d, \"nearest\": %d, \"edges\": %lld},\n",
+            opt->radius, opt->nearest, rangedEdges);
+    fprintf(out, "  \"benchmarks\": [\n");
+    for (int i = 0; i < resultCount; i++) {
+        BenchResult *r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"iterations\": %lld, \"total_ns\": %lld, \"ns_per_op\": %.1f, \"items\": %lld}%s\n",
+                r->name, r->iterations, r->totalNs,
+                r->iterations > 0 ? (double)r->totalNs / r->iterations : 0.0,
+                r->items, i < resultCount - 1 ? "," : "");
+    }
+    fprintf(out, "  ],\n");
+    // No Linux o ru_maxrss vem em kilobytes
+    fprintf(out, "  \"peak_rss_kb\": %ld\n", usage.ru_maxrss);
+    fprintf(out, "}\n");
+}
+
+/** @brief Lê as opções da linha de comandos */
+static bool parseOptions(int argc, char **argv, BenchOptions *opt) {
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) return false;
+        const char *name = argv[i];
+        const char *value = argv[++i];
+        if (strcmp(name, "--rows") == 0) opt->rows = atoi(value);
+        else if (strcmp(name, "--cols") == 0) opt->cols = atoi(value);
+        else if (strcmp(name, "--density") == 0) opt->density = atof(value);
+        else if (strcmp(name, "--frequencies") == 0) opt->frequencies = atoi(value);
+        else if (strcmp(name, "--skew") == 0) opt->skew = atof(value);
+        else if (strcmp(name, "--seed") == 0) opt->seed = strtoull(value, NULL, 10);
+        else if (strcmp(name, "--repeat") == 0) opt->repeat = atoi(value);
+        else if (strcmp(name, "--radius") == 0) opt->radius = atoi(value);
+        else if (strcmp(name, "--nearest") == 0) opt->nearest = atoi(value);
+        else if (strcmp(name, "--output") == 0) opt->output = value;
+        else return false;
+    }
+    int maxFrequencies = (int)sizeof(FREQUENCY_ALPHABET) - 1;
+    return opt->rows > 0 && opt->cols > 0 && opt->density >= 0 && opt->density <= 1
+        && opt->frequencies > 0 && opt->frequencies <= maxFrequencies
+        && opt->skew >= 0 && opt->repeat > 0
+        && opt->radius >= 0 && opt->nearest >= 0 && (opt->radius > 0 || opt->nearest > 0);
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opt = { 256, 256, 0.05, 26, 0.0, 42, 5, 8, 0, NULL };
+    if (!parseOptions(argc, argv, &opt)) {
+        fprintf(stderr, "Usage: %s [--rows N] [--cols M] [--density D] [--frequencies K(1-62)] "
+                        "[--skew S] [--seed X] [--repeat R] [--radius D] [--nearest N] [--output file]\n", argv[0]);
+        return 1;
+    }
+
+    // Ficheiros temporários com o pid, para permitir execuções em paralelo
+    char textFile[64], binaryFile[64], tiledFile[64], editedFile[64];
+    snprintf(textFile, sizeof(textFile), "bench_%d.txt", (int)getpid());
+    snprintf(binaryFile, sizeof(binaryFile), "bench_%d.bin", (int)getpid());
+    snprintf(tiledFile, sizeof(tiledFile), "bench_%d.tiles", (int)getpid());
+    snprintf(editedFile, sizeof(editedFile), "bench_%d_edited.txt", (int)getpid());
+
+    int antennas = 0;
+    long long start = nowNs();
+    AntennaCell *cells = generateGrid(&opt, textFile, &antennas);
+    if (cells == NULL) {
+        fprintf(stderr, "Error generating grid\n");
+        return 1;
+    }
+    record("generate", 1, nowNs() - start, antennas);
+
+    benchReadText(&opt, textFile);
+    benchReload(&opt, cells, antennas, textFile, editedFile);
+    benchBuild(&opt, cells, antennas, GRAPH_EXPLICIT, "build_explicit");
+    benchBuild(&opt, cells, antennas, GRAPH_IMPLICIT, "build_implicit");
+    benchBuildParallel(&opt, cells, antennas);
+    long long rangedEdges = benchBuildRanged(&opt, cells, antennas);
+
+    Graph *g = buildGraph(cells, antennas, GRAPH_EXPLICIT);
+    long long edges = 0;
+    if (g != NULL) {
+        edges = countEdges(g) / 2;
+        benchTraversals(&opt, g);
+        benchQueryCache(&opt, g);
+        benchBitsetTraversal(&opt, g);
+        benchShortestPaths(&opt, g);
+        benchIntersections(&opt, g);
+        benchInterference(&opt, g);
+        benchBinary(&opt, g, binaryFile);
+        benchTiled(&opt, g, textFile, tiledFile);
+        freeGraph(g);
+    }
+    free(cells);
+    remove(textFile);
+    remove(binaryFile);
+    remove(tiledFile);
+    remove(editedFile);
+
+    FILE *out = opt.output != NULL ? fopen(opt.output, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "Error opening %s\n", opt.output);
+        return 1;
+    }
+    writeJson(out, &opt, antennas, edges, rangedEdges);
+    if (out != stdout) fclose(out);
+    return 0;
+}
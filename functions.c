@@ -11,8 +11,375 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "lib/functions.h"
 
+/** Tamanho mínimo de cada bloco do ficheiro processado por uma thread do leitor mapeado */
+#define MAPPED_CHUNK_MIN (1 << 20)
+
+/** Raio das ligações de um grafo criado com createGraphWithMode(GRAPH_RANGED) */
+#define RANGE_DEFAULT_RADIUS 8
+/** Lado das células da grelha espacial quando só há limite de vizinhos, sem raio */
+#define SPATIAL_DEFAULT_CELL 16
+
+/** Número máximo de funções temporizadas pela instrumentação */
+#define INSTRUMENT_MAX_PROBES 128
+
+/**
+ * @struct InstrumentProbe
+ * @brief Tempos acumulados das chamadas de uma função pública.
+ */
+typedef struct InstrumentProbe{
+    const char *name;
+    unsigned long long calls;
+    unsigned long long totalNs;
+    unsigned long long maxNs;
+} InstrumentProbe;
+
+/**
+ * @struct InstrumentScope
+ * @brief Chamada a ser temporizada, fechada automaticamente quando a função termina.
+ */
+typedef struct InstrumentScope{
+    int probe; // -1 se a instrumentação estava desligada no início da chamada
+    unsigned long long start;
+} InstrumentScope;
+
+static bool instrumentOn = false;
+static InstrumentProbe instrumentProbes[INSTRUMENT_MAX_PROBES];
+static int instrumentProbeCount = 0;
+static unsigned long long instrumentCounters[INSTRUMENT_COUNTER_COUNT];
+static pthread_mutex_t instrumentLock = PTHREAD_MUTEX_INITIALIZER;
+static const char *instrumentReportPath = NULL;
+
+/** Nomes dos contadores no relatório, pela ordem do InstrumentCounter */
+static const char *const instrumentCounterNames[INSTRUMENT_COUNTER_COUNT] = {
+    "vertices", "edges", "allocations", "allocated_bytes", "bytes_read", "bytes_written"
+};
+
+#ifndef GRAPH_NO_INSTRUMENTATION
+/** @brief Relógio monotónico em nanossegundos */
+static unsigned long long instrumentNow(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief Início de uma chamada temporizada
+ * 
+ * Com a instrumentação desligada custa apenas a leitura de uma variável. Cada função
+ * tem a sua posição na tabela, atribuída na primeira chamada com a instrumentação ligada.
+ * 
+ * @param site Posição da função na tabela (-1 enquanto não foi atribuída)
+ * @param name Nome da função
+ * @return InstrumentScope Chamada a fechar pelo instrumentEnd
+ */
+static InstrumentScope instrumentBegin(int *site, const char *name){
+    InstrumentScope scope = { -1, 0 };
+    if (!__atomic_load_n(&instrumentOn, __ATOMIC_RELAXED)) return scope;
+
+    int probe = __atomic_load_n(site, __ATOMIC_ACQUIRE);
+    if (probe < 0) {
+        pthread_mutex_lock(&instrumentLock);
+        probe = *site;
+        if (probe < 0 && instrumentProbeCount < INSTRUMENT_MAX_PROBES) {
+            probe = instrumentProbeCount;
+            instrumentProbes[probe].name = name;
+            __atomic_store_n(&instrumentProbeCount, probe + 1, __ATOMIC_RELEASE);
+            __atomic_store_n(site, probe, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&instrumentLock);
+        if (probe < 0) return scope;
+    }
+    scope.probe = probe;
+    scope.start = instrumentNow();
+    return scope;
+}
+
+/** @brief Fim de uma chamada temporizada: acumula o tempo na função */
+static void instrumentEnd(InstrumentScope *scope){
+    if (scope->probe < 0) return;
+    unsigned long long elapsed = instrumentNow() - scope->start;
+    InstrumentProbe *p = &instrumentProbes[scope->probe];
+    __atomic_fetch_add(&p->calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&p->totalNs, elapsed, __ATOMIC_RELAXED);
+    unsigned long long max = __atomic_load_n(&p->maxNs, __ATOMIC_RELAXED);
+    while (elapsed > max
+           && !__atomic_compare_exchange_n(&p->maxNs, &max, elapsed, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/** Temporiza a função atual, desde este ponto até qualquer return */
+#define INSTRUMENT_FUNCTION() \
+    static int instrumentSite = -1; \
+    InstrumentScope instrumentScope __attribute__((cleanup(instrumentEnd))) = \
+        instrumentBegin(&instrumentSite, __func__)
+#else
+/** Com -DGRAPH_NO_INSTRUMENTATION as funções não são temporizadas nem os contadores atualizados */
+#define INSTRUMENT_FUNCTION() ((void)0)
+#endif
+
+/** @brief Soma uma quantidade a um contador, se a instrumentação estiver ligada */
+static inline void instrumentCount(InstrumentCounter counter, unsigned long long amount){
+#ifndef GRAPH_NO_INSTRUMENTATION
+    if (__atomic_load_n(&instrumentOn, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&instrumentCounters[counter], amount, __ATOMIC_RELAXED);
+    }
+#else
+    (void)counter;
+    (void)amount;
+#endif
+}
+
+/** @brief Conta uma alocação de memória */
+static inline void instrumentAllocation(size_t bytes){
+    instrumentCount(INSTRUMENT_ALLOCATIONS, 1);
+    instrumentCount(INSTRUMENT_ALLOCATED_BYTES, bytes);
+}
+
+/**
+ * @brief Liga ou desliga a instrumentação (tempos das funções públicas e contadores)
+ * 
+ * @param enabled true para ligar
+ */
+void setInstrumentation(bool enabled){
+    __atomic_store_n(&instrumentOn, enabled, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Indica se a instrumentação está ligada
+ * 
+ * @return true se está ligada
+ */
+bool instrumentationEnabled(){
+    return __atomic_load_n(&instrumentOn, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Põe a zero os contadores e os tempos de todas as funções
+ * 
+ * Não deve ser chamada enquanto outras threads usam a biblioteca.
+ */
+void resetInstrumentation(){
+    pthread_mutex_lock(&instrumentLock);
+    for (int i = 0; i < INSTRUMENT_COUNTER_COUNT; i++) instrumentCounters[i] = 0;
+    for (int i = 0; i < instrumentProbeCount; i++) {
+        instrumentProbes[i].calls = 0;
+        instrumentProbes[i].totalNs = 0;
+        instrumentProbes[i].maxNs = 0;
+    }
+    pthread_mutex_unlock(&instrumentLock);
+}
+
+/**
+ * @brief Devolve o valor atual de um contador da instrumentação
+ * 
+ * @param counter Contador
+ * @return unsigned long long Valor do contador
+ */
+unsigned long long instrumentationCounter(InstrumentCounter counter){
+    if (counter < 0 || counter >= INSTRUMENT_COUNTER_COUNT) return 0;
+    return __atomic_load_n(&instrumentCounters[counter], __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Escreve o relatório da instrumentação em JSON
+ * 
+ * Os tempos de cada função incluem as funções públicas que ela chama.
+ * Só aparecem as funções chamadas com a instrumentação ligada.
+ * 
+ * @param f Ficheiro de destino
+ * @return true se o relatório foi escrito
+ */
+bool writeInstrumentationReport(FILE *f){
+    if (f == NULL) return false;
+    fprintf(f, "{\n  \"counters\": {");
+    for (int i = 0; i < INSTRUMENT_COUNTER_COUNT; i++) {
+        fprintf(f, "%s\"%s\": %llu", i > 0 ? ", " : "", instrumentCounterNames[i], instrumentationCounter(i));
+    }
+    fprintf(f, "},\n  \"functions\": [");
+
+    int probes = __atomic_load_n(&instrumentProbeCount, __ATOMIC_ACQUIRE);
+    bool first = true;
+    for (int i = 0; i < probes; i++) {
+        InstrumentProbe *p = &instrumentProbes[i];
+        unsigned long long calls = __atomic_load_n(&p->calls, __ATOMIC_RELAXED);
+        if (calls == 0) continue;
+        unsigned long long total = __atomic_load_n(&p->totalNs, __ATOMIC_RELAXED);
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"calls\": %llu, \"total_ns\": %llu, \"avg_ns\": %.1f, \"max_ns\": %llu}",
+                first ? "" : ",", p->name, calls, total, (double)total / calls,
+                __atomic_load_n(&p->maxNs, __ATOMIC_RELAXED));
+        first = false;
+    }
+    fprintf(f, "%s]\n}\n", first ? "" : "\n  ");
+    return ferror(f) == 0;
+}
+
+/** @brief Escreve o relatório no fim do programa, quando foi pedido pela variável de ambiente */
+static void instrumentAtExit(void){
+    if (strcmp(instrumentReportPath, "1") == 0) {
+        writeInstrumentationReport(stderr);
+        return;
+    }
+    FILE *f = fopen(instrumentReportPath, "w");
+    if (f == NULL) return;
+    writeInstrumentationReport(f);
+    fclose(f);
+}
+
+/**
+ * @brief Liga a instrumentação ao carregar o programa se GRAPH_INSTRUMENT estiver definida
+ * 
+ * GRAPH_INSTRUMENT=1 escreve o relatório para o stderr no fim do programa; qualquer
+ * outro valor (exceto 0) é o nome do ficheiro onde o relatório é escrito.
+ */
+__attribute__((constructor)) static void instrumentFromEnvironment(void){
+    const char *value = getenv("GRAPH_INSTRUMENT");
+    if (value == NULL || value[0] == '\0' || strcmp(value, "0") == 0) return;
+    instrumentReportPath = value;
+    setInstrumentation(true);
+    atexit(instrumentAtExit);
+}
+
+/** BFS por bitsets: passa a bottom-up quando as arestas da fronteira excedem 1/ALPHA das por visitar */
+#define BFS_ALPHA 14
+/** BFS por bitsets: volta a top-down quando a fronteira tem menos de 1/BETA dos vértices */
+#define BFS_BETA 24
+
+/** Abaixo deste número de ligações o buildGraphParallel não cria threads */
+#define PARALLEL_BUILD_MIN_LINKS 65536
+
+/** Número de nós do primeiro bloco de um pool */
+#define POOL_FIRST_BLOCK_ITEMS 64
+/** Número máximo de nós de um bloco de um pool */
+#define POOL_MAX_BLOCK_ITEMS 65536
+/** Alinhamento dos nós e do início da zona de nós de cada bloco */
+#define POOL_ALIGNMENT 16
+
+/**
+ * @brief Inicializa um pool vazio para nós de um determinado tamanho
+ * 
+ * @param pool Pointer para o pool
+ * @param itemSize Tamanho de cada nó
+ */
+static void poolInit(NodePool *pool, size_t itemSize){
+    // Cada nó tem de conseguir guardar o pointer da lista de livres
+    if (itemSize < sizeof(void*)) itemSize = sizeof(void*);
+    pool->itemSize = (itemSize + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+    pool->nextBlockItems = POOL_FIRST_BLOCK_ITEMS;
+    pool->blocks = NULL;
+    pool->cursor = NULL;
+    pool->limit = NULL;
+    pool->freeList = NULL;
+}
+
+/**
+ * @brief Atribui um nó do pool
+ * 
+ * Reutiliza um nó devolvido se existir; caso contrário avança o cursor do bloco atual,
+ * alocando um novo bloco (com o dobro dos nós do anterior) quando este está cheio.
+ * 
+ * @param pool Pointer para o pool
+ * @return void* Pointer para o nó, ou NULL se faltar memória
+ */
+static void *poolAlloc(NodePool *pool){
+    if (pool->freeList != NULL) {
+        void *item = pool->freeList;
+        pool->freeList = *(void**)item;
+        return item;
+    }
+
+    if (pool->cursor == pool->limit) {
+        size_t header = (sizeof(PoolBlock) + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+        size_t items = (size_t)pool->nextBlockItems;
+        PoolBlock *block = (PoolBlock*)malloc(header + items * pool->itemSize);
+        if (block == NULL) return NULL;
+        instrumentAllocation(header + items * pool->itemSize);
+
+        block->next = pool->blocks;
+        pool->blocks = block;
+        pool->cursor = (char*)block + header;
+        pool->limit = pool->cursor + items * pool->itemSize;
+        if (pool->nextBlockItems < POOL_MAX_BLOCK_ITEMS) pool->nextBlockItems *= 2;
+    }
+
+    void *item = pool->cursor;
+    pool->cursor += pool->itemSize;
+    return item;
+}
+
+/**
+ * @brief Devolve um nó ao pool para ser reutilizado
+ * 
+ * @param pool Pointer para o pool
+ * @param item Nó atribuído anteriormente pelo poolAlloc do mesmo pool
+ */
+static void poolRelease(NodePool *pool, void *item){
+    *(void**)item = pool->freeList;
+    pool->freeList = item;
+}
+
+/**
+ * @brief Liberta todos os blocos de um pool
+ * 
+ * @param pool Pointer para o pool
+ */
+static void poolDestroy(NodePool *pool){
+    PoolBlock *block = pool->blocks;
+    while (block != NULL) {
+        PoolBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    pool->blocks = NULL;
+    pool->cursor = NULL;
+    pool->limit = NULL;
+    pool->freeList = NULL;
+}
+
+/**
+ * @brief Passa todos os blocos e nós livres de um pool para outro do mesmo tamanho de nó
+ * 
+ * O pool de destino continua a atribuir nós do seu bloco atual; o que resta do bloco
+ * atual do pool de origem não é reutilizado. O pool de origem fica vazio.
+ * 
+ * @param into Pool que fica com os blocos
+ * @param from Pool de onde saem os blocos
+ */
+static void poolMerge(NodePool *into, NodePool *from){
+    if (from->blocks != NULL) {
+        PoolBlock *last = from->blocks;
+        while (last->next != NULL) last = last->next;
+        last->next = into->blocks;
+        into->blocks = from->blocks;
+        // Se o destino ainda não tinha blocos, passa a continuar o bloco atual da origem
+        if (into->cursor == NULL) {
+            into->cursor = from->cursor;
+            into->limit = from->limit;
+        }
+        if (from->nextBlockItems > into->nextBlockItems) into->nextBlockItems = from->nextBlockItems;
+    }
+    if (from->freeList != NULL) {
+        void *last = from->freeList;
+        while (*(void**)last != NULL) last = *(void**)last;
+        *(void**)last = into->freeList;
+        into->freeList = from->freeList;
+    }
+    from->blocks = NULL;
+    from->cursor = NULL;
+    from->limit = NULL;
+    from->freeList = NULL;
+}
+
 /**
  * @brief Cria e inicializa um grafo vazio
  * 
@@ -22,542 +389,5532 @@
  * @return Graph* Pointer para o grafo criado
  */
 Graph *createGraph(){
-    Graph *g = (Graph*)malloc(sizeof(Graph));
+    return createGraphWithMode(GRAPH_EXPLICIT);
+}
+
+/**
+ * @brief Cria e inicializa um grafo vazio com a representação de ligações indicada
+ * 
+ * No modo GRAPH_IMPLICIT o addVertex não cria nós AdjList: as ligações entre antenas
+ * da mesma frequência são deduzidas das listas de membros de cada frequência.
+ * No modo GRAPH_RANGED as ligações ficam limitadas a RANGE_DEFAULT_RADIUS; para outros
+ * limites usa-se o createGraphWithRange.
+ * 
+ * @param mode Representação das ligações da mesma frequência
+ * @return Graph* Pointer para o grafo criado
+ */
+Graph *createGraphWithMode(GraphMode mode){
+    if (mode == GRAPH_RANGED) return createGraphWithRange(RANGE_DEFAULT_RADIUS, 0);
+    // calloc deixa as listas de membros de todas as frequências vazias
+    Graph *g = (Graph*)calloc(1, sizeof(Graph));
+    if (g == NULL) return NULL;
+    instrumentAllocation(sizeof(Graph));
     g->vertices = NULL;
+    g->vertexCount = 0;
+    g->mode = mode;
+    poolInit(&g->vertexPool, sizeof(Vertex));
+    poolInit(&g->edgePool, sizeof(AdjList));
     return g;
 }
+
 /**
- * @brief Cria um novo vértice (antena)
+ * @brief Cria um grafo que só liga antenas da mesma frequência próximas umas das outras
  * 
- * Esta função aloca aa memória para um novo vértice e define os seus atributos.
- * No fim inicializa as adjacencias e o próximo vértice como NULL.  
+ * Cada nova antena liga-se às antenas da mesma frequência a uma distância (euclidiana)
+ * não superior a radius e, se nearest for positivo, apenas às nearest mais próximas
+ * dessas. As candidatas são procuradas numa grelha uniforme, sem percorrer todos os
+ * membros da frequência, pelo que o número de ligações cresce linearmente com o número
+ * de antenas em vez de quadraticamente. Com nearest, cada antena escolhe entre as que
+ * já estavam no grafo quando foi inserida.
+ * 
+ * @param radius Distância máxima das ligações, ou 0 para não limitar a distância
+ * @param nearest Número máximo de ligações criadas por cada nova antena, ou 0 para não limitar
+ * @return Graph* Pointer para o grafo criado, ou NULL se os limites são inválidos
+ *         (negativos ou ambos 0) ou faltou memória
+ */
+Graph *createGraphWithRange(int radius, int nearest){
+    if (radius < 0 || nearest < 0 || (radius == 0 && nearest == 0)) return NULL;
+    Graph *g = createGraphWithMode(GRAPH_EXPLICIT);
+    if (g == NULL) return NULL;
+    g->mode = GRAPH_RANGED;
+
+    SpatialGrid *grid = &g->grid;
+    grid->radius = radius;
+    grid->nearest = nearest;
+    grid->cellSize = radius > 0 ? radius : SPATIAL_DEFAULT_CELL;
+    if (nearest > 0) {
+        grid->best = (Vertex**)malloc(sizeof(Vertex*) * nearest);
+        grid->bestDistance = (long long*)malloc(sizeof(long long) * nearest);
+        if (grid->best == NULL || grid->bestDistance == NULL) {
+            freeGraph(g);
+            return NULL;
+        }
+    }
+    return g;
+}
+
+/**
+ * @brief Encontra a raiz da componente de um vértice, sem alterar a floresta
+ * 
+ * @param set Pointer para o union-find
+ * @param id Identificador do vértice
+ * @return int Identificador da raiz
+ */
+static int componentRoot(const ComponentSet *set, int id){
+    while (set->parent[id] != id) {
+        id = set->parent[id];
+    }
+    return id;
+}
+
+/**
+ * @brief Encontra a raiz da componente de um vértice e liga todo o caminho diretamente a ela
+ * 
+ * @param set Pointer para o union-find
+ * @param id Identificador do vértice
+ * @return int Identificador da raiz
+ */
+static int componentCompress(ComponentSet *set, int id){
+    int root = componentRoot(set, id);
+    while (set->parent[id] != root) {
+        int next = set->parent[id];
+        set->parent[id] = root;
+        id = next;
+    }
+    return root;
+}
+
+/**
+ * @brief Acrescenta ao union-find um vértice isolado
+ * 
+ * @param set Pointer para o union-find
+ * @param id Identificador do novo vértice
+ * @return true se o vértice foi acrescentado, false se faltou memória
+ */
+static bool componentAdd(ComponentSet *set, int id){
+    if (id >= set->capacity) {
+        int newCapacity = set->capacity > 0 ? set->capacity * 2 : 64;
+        while (newCapacity <= id) newCapacity *= 2;
+        int *parent = (int*)realloc(set->parent, sizeof(int) * newCapacity);
+        if (parent == NULL) return false;
+        set->parent = parent;
+        int *size = (int*)realloc(set->size, sizeof(int) * newCapacity);
+        if (size == NULL) return false;
+        set->size = size;
+        instrumentAllocation(sizeof(int) * newCapacity);
+        instrumentAllocation(sizeof(int) * newCapacity);
+        set->capacity = newCapacity;
+    }
+    set->parent[id] = id;
+    set->size[id] = 1;
+    set->count++;
+    return true;
+}
+
+/**
+ * @brief Junta as componentes de dois vértices, pendurando a menor na maior
+ * 
+ * @param set Pointer para o union-find
+ * @param a Identificador do vértice A
+ * @param b Identificador do vértice B
+ */
+static void componentUnion(ComponentSet *set, int a, int b){
+    if (a < 0 || b < 0 || a >= set->capacity || b >= set->capacity) return;
+    int rootA = componentCompress(set, a);
+    int rootB = componentCompress(set, b);
+    if (rootA == rootB) return;
+    if (set->size[rootA] < set->size[rootB]) {
+        int t = rootA;
+        rootA = rootB;
+        rootB = t;
+    }
+    set->parent[rootB] = rootA;
+    set->size[rootA] += set->size[rootB];
+    set->count--;
+}
+/**
+ * @brief Define os atributos de um vértice acabado de alocar
  * 
+ * @param v Pointer para o vértice
  * @param x Coordenada X
  * @param y Coordenada Y
  * @param frequency Carácter que representa a frequência da antena
- * @return Vertex* Pointer para o vértice criado
  */
-Vertex *createVertex(int x, int y, char frequency){
-    Vertex *v = (Vertex*)malloc(sizeof(Vertex));
+static void initVertex(Vertex *v, int x, int y, char frequency){
     v->x = x;
     v->y = y;
     v->frequency = frequency;
+    // o identificador só é atribuído quando o vértice é inserido num grafo
+    v->id = -1;
     // indicicar que a nova antena não tem adjacentes
     v->adjacents = NULL;
     // indicar que ainda não é para estar ligado a outro vértice na lista do grafo
     v->next = NULL;
+    v->prev = NULL;
+    v->freqPrev = NULL;
+    v->freqNext = NULL;
+    v->cellNext = NULL;
+}
 
+/**
+ * @brief Cria um novo vértice (antena)
+ * 
+ * Esta função aloca aa memória para um novo vértice e define os seus atributos.
+ * No fim inicializa as adjacencias e o próximo vértice como NULL.  
+ * 
+ * @param x Coordenada X
+ * @param y Coordenada Y
+ * @param frequency Carácter que representa a frequência da antena
+ * @return Vertex* Pointer para o vértice criado
+ */
+Vertex *createVertex(int x, int y, char frequency){
+    Vertex *v = (Vertex*)malloc(sizeof(Vertex));
+    if (v == NULL) return NULL;
+    initVertex(v, x, y, frequency);
     return v;
 }
 
+
 /**
- * @brief Adiciona uma aresta bidirecional entre dois vértices
- * 
- * Esta função cria ligações entre dois vértices (antenas), adicionando cada uma na lista de adjacentes.
+ * @brief Cria os dois nós AdjList de uma ligação, no início das listas de A e de B
  * 
+ * @param pool Pool de onde saem os nós
  * @param a Vértice A
  * @param b Vértice B
+ * @return true se a ligação foi criada, false se faltou memória
  */
-void addEdge(Vertex *a, Vertex *b){
+static bool linkVertices(NodePool *pool, Vertex *a, Vertex *b){
+    AdjList *adjB = (AdjList*)poolAlloc(pool);
+    AdjList *adjA = (AdjList*)poolAlloc(pool);
+    if (adjB == NULL || adjA == NULL) {
+        if (adjB != NULL) poolRelease(pool, adjB);
+        if (adjA != NULL) poolRelease(pool, adjA);
+        return false;
+    }
+
     // adiciona B à lista de vizinhos (adjacência) de A
-    AdjList *adjB = (AdjList*)malloc(sizeof(AdjList));
     adjB->vertex = b;
     adjB->next = a->adjacents;
+    adjB->prev = NULL;
+    if (a->adjacents != NULL) a->adjacents->prev = adjB;
     a->adjacents = adjB;
 
     // adiciona A à lista de vizinhos (adjacência) de B
-    AdjList *adjA = (AdjList*)malloc(sizeof(AdjList));
     adjA->vertex = a;
     adjA->next = b->adjacents;
+    adjA->prev = NULL;
+    if (b->adjacents != NULL) b->adjacents->prev = adjA;
     b->adjacents = adjA;
+
+    // Cada nó conhece o nó da ligação inversa, para o removeVertex
+    adjB->twin = adjA;
+    adjA->twin = adjB;
+    instrumentCount(INSTRUMENT_EDGES, 1);
+    return true;
 }
 
-/** 
- * @brief Adiciona um novo vértice ao grafo e conecta com os da mesma frequência
+/**
+ * @brief Adiciona uma aresta bidirecional entre dois vértices
  * 
- * Esta função adiciona o vértice àa lista de vértices do grafo e conecta com arestas 
- * os outros vértices da mesma frequencia
+ * Esta função cria ligações entre dois vértices (antenas), adicionando cada uma na lista de adjacentes.
+ * Os dois nós AdjList são atribuídos pelo pool de arestas do grafo.
  * 
- * @param g Pointer para o grafo
- * @param x Coordenada X do novo vértice
- * @param y Coordenada Y do novo vértice
- * @param frequency Frequência do novo vértice
+ * @param g Pointer para o grafo a que os vértices pertencem
+ * @param a Vértice A
+ * @param b Vértice B
  */
-void addVertex(Graph *g, int x, int y, char frequency){
-    // Cria um novo vértice com as coordenadas e frequência indicadas
-    Vertex *newV = createVertex(x, y, frequency);
-
-    // Conectar com vértices da mesma frequência
-    Vertex *current = g->vertices;;
-    while (current != NULL){
-        if(current->frequency == frequency){
-            addEdge(newV, current);
-        }
-        current = current->next;
-    }
+void addEdge(Graph *g, Vertex *a, Vertex *b){
+    if (!linkVertices(&g->edgePool, a, b)) return;
+    g->version++;
 
-    // Inserir novo vértice na lista de vértices
-    newV->next = g->vertices;
-    g->vertices = newV;
+    // As pesquisas só seguem ligações entre antenas da mesma frequência
+    if (a->frequency == b->frequency) componentUnion(&g->components, a->id, b->id);
 }
 
 /**
- * @brief Imprime o conteúdo do grafo
+ * @brief Calcula a posição inicial de uma coordenada no índice do grafo
  * 
- * Função para imprimir todos os vértices do grafo, assinalando as coordenadas
- * e frequencia, bem como os vértices adjacentes.
+ * @param x Coordenada X
+ * @param y Coordenada Y
+ * @param mask Capacidade do índice menos 1
+ * @return unsigned int Posição inicial da sondagem
+ */
+static unsigned int indexSlot(int x, int y, unsigned int mask){
+    unsigned int h = (unsigned int)x * 0x9E3779B1u ^ (unsigned int)y * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h & mask;
+}
+
+/**
+ * @brief Insere um vértice no índice de coordenadas, sem verificar a capacidade
  * 
- * @param g Pointer para grafo
+ * @param index Pointer para o índice
+ * @param v Vértice a inserir
  */
-void printGraph(Graph* g) {
-    // Variável auxiliar para percorrer todos os vértices do grafo
-    Vertex *v = g->vertices;
-    while (v != NULL) {
-            printf("Antenna (%d, %d) [%c] -> ", v->x, v->y, v->frequency);
-        // Variável auxiliar para percorrer todas as adjaacentes dos vértices
-        AdjList *adj = v->adjacents;
-        while (adj != NULL) {
-            printf("(%d, %d) ", adj->vertex->x, adj->vertex->y);
-            adj = adj->next;
-        }
-        printf("\n");
-        v = v->next;
+static void indexPut(VertexIndex *index, Vertex *v){
+    unsigned int mask = (unsigned int)index->capacity - 1;
+    unsigned int slot = indexSlot(v->x, v->y, mask);
+    while (index->slots[slot] != NULL) {
+        slot = (slot + 1) & mask;
     }
+    index->slots[slot] = v;
+    index->count++;
 }
 
 /**
- * @brief Lê um grafo de um ficheiro de texto
+ * @brief Insere um vértice no índice de coordenadas do grafo
  * 
- * Esta função lê cada linha do ficheiro, interpreta caracteres diferentes de '.' como antenas,
- * e insere um vértice com a frequência correspondente e as respetivas coordenadas (linha, coluna).
- * Cada antena é adicionada ao grafo como um novo vértice.
+ * Duplica a capacidade sempre que a ocupação passaria de metade, para manter
+ * as sondagens curtas.
  * 
- * @param filename Nome de ficheiro de texto a ser lido
- * @return Graph* Pointer para o grafo construído
+ * @param g Pointer para o grafo
+ * @param v Vértice a inserir
+ * @return true se o vértice foi indexado, false se faltou memória
  */
-Graph *readGraphFromFile(const char *filename){
-    FILE *file = fopen(filename, "r");
-    if (file == NULL){
-        return NULL;
-    }
-
-    Graph *g = createGraph();
-    char *line = NULL; // Pointer que vai guardar cada linha lida
-    size_t len = 0;    // Tamanho do buffer (é ajustado automaticamente pelo getline)
-    int x = 0;
-
-  //lê cada linha até ao final do ficheiro
-  while (getline(&line, &len, file) != -1) {
-        int y = 0; // Agora y representa a coluna
-        for (int i = 0; line[i] != '\0'; i++) {
-            // Ignora espaços ou tabs
-            if (line[i] == ' ' || line[i] == '\t') continue;
+static bool indexInsert(Graph *g, Vertex *v){
+    VertexIndex *index = &g->index;
+    if ((index->count + 1) * 2 > index->capacity) {
+        int newCapacity = index->capacity > 0 ? index->capacity * 2 : 64;
+        Vertex **newSlots = (Vertex**)calloc(newCapacity, sizeof(Vertex*));
+        if (newSlots == NULL) return false;
+        instrumentAllocation(sizeof(Vertex*) * newCapacity);
 
-            // '.' representa célula vazia, ignora
-            if (line[i] != '.' && line[i] != '\n') {
-                // Troca x e y na chamada
-                addVertex(g, x, y, line[i]);
-            }
-            y++;
+        Vertex **oldSlots = index->slots;
+        int oldCapacity = index->capacity;
+        index->slots = newSlots;
+        index->capacity = newCapacity;
+        index->count = 0;
+        for (int i = 0; i < oldCapacity; i++) {
+            if (oldSlots[i] != NULL) indexPut(index, oldSlots[i]);
         }
-        x++;
+        free(oldSlots);
     }
+    indexPut(index, v);
+    return true;
+}
 
-    free(line);
-    fclose(file);
-    return g;
+/**
+ * @brief Procura um vértice pelas coordenadas e frequência usando o índice do grafo
+ * 
+ * @param g Pointer para o grafo
+ * @param x Coordenada X
+ * @param y Coordenada Y
+ * @param frequency Frequência do vértice
+ * @return Vertex* Pointer para o vértice, ou NULL se não existir
+ */
+Vertex *findVertex(Graph *g, int x, int y, char frequency){
+    if (g == NULL || g->index.capacity == 0) return NULL;
+
+    unsigned int mask = (unsigned int)g->index.capacity - 1;
+    unsigned int slot = indexSlot(x, y, mask);
+    Vertex *v;
+    while ((v = g->index.slots[slot]) != NULL) {
+        if (v->x == x && v->y == y && v->frequency == frequency) return v;
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
 }
 
 /**
- * @brief Escreve um grafo para um ficheiro binário.
+ * @brief Divide arredondando para baixo, para as células de coordenadas negativas
+ * 
+ * @param a Dividendo
+ * @param b Divisor (positivo)
+ * @return int Quociente arredondado para baixo
+ */
+static int floorDivide(int a, int b){
+    int q = a / b;
+    if (a % b != 0 && a < 0) q--;
+    return q;
+}
+
+/**
+ * @brief Calcula a posição inicial de uma célula na tabela da grelha espacial
+ * 
+ * @param cx Coordenada X da célula
+ * @param cy Coordenada Y da célula
+ * @param frequency Frequência das antenas da célula
+ * @param mask Capacidade da tabela menos 1
+ * @return unsigned int Posição inicial da sondagem
+ */
+static unsigned int gridSlot(int cx, int cy, char frequency, unsigned int mask){
+    unsigned int h = indexSlot(cx, cy, UINT_MAX) ^ (unsigned int)(unsigned char)frequency * 0x27D4EB2Du;
+    h ^= h >> 16;
+    return h & mask;
+}
+
+/**
+ * @brief Procura uma célula da grelha espacial
+ * 
+ * @param grid Pointer para a grelha
+ * @param cx Coordenada X da célula
+ * @param cy Coordenada Y da célula
+ * @param frequency Frequência das antenas
+ * @return SpatialCell* Pointer para a célula, ou NULL se nunca teve antenas
+ */
+static SpatialCell *gridFind(SpatialGrid *grid, int cx, int cy, char frequency){
+    if (grid->capacity == 0) return NULL;
+    unsigned int mask = (unsigned int)grid->capacity - 1;
+    unsigned int slot = gridSlot(cx, cy, frequency, mask);
+    while (grid->cells[slot].used) {
+        SpatialCell *cell = &grid->cells[slot];
+        if (cell->cx == cx && cell->cy == cy && cell->frequency == frequency) return cell;
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Insere um vértice na sua célula da grelha espacial
+ * 
+ * Duplica a capacidade sempre que a ocupação passaria de metade; as células que
+ * ficaram vazias não passam para a nova tabela.
+ * 
+ * @param grid Pointer para a grelha
+ * @param v Vértice a inserir
+ * @return true se o vértice foi inserido, false se faltou memória
+ */
+static bool gridInsert(SpatialGrid *grid, Vertex *v){
+    int cx = floorDivide(v->x, grid->cellSize);
+    int cy = floorDivide(v->y, grid->cellSize);
+    SpatialCell *cell = gridFind(grid, cx, cy, v->frequency);
+
+    if (cell == NULL) {
+        if ((grid->count + 1) * 2 > grid->capacity) {
+            int newCapacity = grid->capacity > 0 ? grid->capacity * 2 : 64;
+            SpatialCell *newCells = (SpatialCell*)calloc(newCapacity, sizeof(SpatialCell));
+            if (newCells == NULL) return false;
+            instrumentAllocation(sizeof(SpatialCell) * newCapacity);
+
+            unsigned int mask = (unsigned int)newCapacity - 1;
+            int count = 0;
+            for (int i = 0; i < grid->capacity; i++) {
+                SpatialCell *old = &grid->cells[i];
+                if (!old->used || old->members == NULL) continue;
+                unsigned int slot = gridSlot(old->cx, old->cy, old->frequency, mask);
+                while (newCells[slot].used) slot = (slot + 1) & mask;
+                newCells[slot] = *old;
+                count++;
+            }
+            free(grid->cells);
+            grid->cells = newCells;
+            grid->capacity = newCapacity;
+            grid->count = count;
+        }
+        unsigned int mask = (unsigned int)grid->capacity - 1;
+        unsigned int slot = gridSlot(cx, cy, v->frequency, mask);
+        while (grid->cells[slot].used) slot = (slot + 1) & mask;
+        cell = &grid->cells[slot];
+        cell->cx = cx;
+        cell->cy = cy;
+        cell->frequency = v->frequency;
+        cell->used = true;
+        cell->members = NULL;
+        grid->count++;
+    }
+
+    v->cellNext = cell->members;
+    cell->members = v;
+    return true;
+}
+
+/**
+ * @brief Retira um vértice da sua célula da grelha espacial
+ * 
+ * A célula fica na tabela mesmo que fique vazia, para não partir as sondagens.
+ * 
+ * @param grid Pointer para a grelha
+ * @param v Vértice a retirar
+ */
+static void gridRemove(SpatialGrid *grid, Vertex *v){
+    SpatialCell *cell = gridFind(grid, floorDivide(v->x, grid->cellSize),
+                                 floorDivide(v->y, grid->cellSize), v->frequency);
+    if (cell == NULL) return;
+    for (Vertex **link = &cell->members; *link != NULL; link = &(*link)->cellNext) {
+        if (*link == v) {
+            *link = v->cellNext;
+            v->cellNext = NULL;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Avalia uma antena candidata a ser ligada a v no modo GRAPH_RANGED
+ * 
+ * Sem limite de vizinhos liga logo as que estão dentro do raio; com limite guarda-as
+ * em grid->best, ordenadas pela distância (as empatadas pela ordem em que foram vistas).
+ * 
+ * @param g Pointer para o grafo
+ * @param v Vértice a ligar
+ * @param candidate Antena da mesma frequência
+ * @param found Número de candidatos já guardados em grid->best
+ * @return int Novo número de candidatos guardados
+ */
+static int considerInRange(Graph *g, Vertex *v, Vertex *candidate, int found){
+    SpatialGrid *grid = &g->grid;
+    long long dx = (long long)candidate->x - v->x;
+    long long dy = (long long)candidate->y - v->y;
+    long long distance = dx * dx + dy * dy;
+    if (grid->radius > 0 && distance > (long long)grid->radius * grid->radius) return found;
+
+    if (grid->nearest == 0) {
+        addEdge(g, v, candidate);
+        return found;
+    }
+    if (found == grid->nearest && distance >= grid->bestDistance[found - 1]) return found;
+
+    int i = found < grid->nearest ? found++ : found - 1;
+    while (i > 0 && grid->bestDistance[i - 1] > distance) {
+        grid->best[i] = grid->best[i - 1];
+        grid->bestDistance[i] = grid->bestDistance[i - 1];
+        i--;
+    }
+    grid->best[i] = candidate;
+    grid->bestDistance[i] = distance;
+    return found;
+}
+
+/**
+ * @brief Liga um vértice às antenas da mesma frequência dentro dos limites do grafo
+ * 
+ * Percorre as células da grelha em anéis à volta da célula do vértice. Com raio basta o
+ * primeiro anel; só com limite de vizinhos os anéis continuam até os seguintes já não
+ * poderem ter antenas mais próximas do que a última escolhida. Se a frequência for tão
+ * esparsa que os anéis custariam mais do que a lista de membros, percorre-se a lista.
+ * 
+ * @param g Pointer para o grafo (modo GRAPH_RANGED)
+ * @param v Vértice a ligar, ainda fora da grelha
+ * @param others Número de outros membros da frequência
+ */
+static void linkInRange(Graph *g, Vertex *v, int others){
+    SpatialGrid *grid = &g->grid;
+    if (others <= 0) return;
+    int cx = floorDivide(v->x, grid->cellSize);
+    int cy = floorDivide(v->y, grid->cellSize);
+    int maxRing = grid->radius > 0 ? 1 : INT_MAX;
+    long long probeLimit = 4LL * others + 64;
+    long long probes = 0;
+    int found = 0, seen = 0;
+
+    for (int ring = 0; ring <= maxRing && seen < others; ring++) {
+        // Uma antena do anel ring está a pelo menos (ring - 1) * cellSize + 1 em x ou em y
+        if (ring > 0 && found > 0 && found == grid->nearest) {
+            long long gap = (long long)(ring - 1) * grid->cellSize + 1;
+            if (gap * gap > grid->bestDistance[found - 1]) break;
+        }
+        if (probes > probeLimit) {
+            found = 0;
+            for (Vertex *m = g->frequencyHead[(unsigned char)v->frequency]; m != NULL; m = m->freqNext) {
+                if (m != v) found = considerInRange(g, v, m, found);
+            }
+            break;
+        }
+        for (int dx = -ring; dx <= ring; dx++) {
+            // Nas colunas do meio do anel só as células de cima e de baixo são novas
+            int step = (dx == -ring || dx == ring) ? 1 : 2 * ring;
+            for (int dy = -ring; dy <= ring; dy += step) {
+                probes++;
+                SpatialCell *cell = gridFind(grid, cx + dx, cy + dy, v->frequency);
+                if (cell == NULL) continue;
+                for (Vertex *m = cell->members; m != NULL; m = m->cellNext) {
+                    seen++;
+                    found = considerInRange(g, v, m, found);
+                }
+            }
+        }
+    }
+
+    // A mais próxima fica no início da lista de adjacência
+    for (int i = found - 1; i >= 0; i--) {
+        addEdge(g, v, grid->best[i]);
+    }
+}
+
+/**
+ * @brief Recalcula as componentes de uma frequência a partir das suas ligações
+ * 
+ * No modo GRAPH_RANGED retirar ou mover uma antena pode partir a componente em várias,
+ * o que o union-find não sabe desfazer: as componentes da frequência são refeitas com
+ * as ligações atuais, em tempo proporcional aos membros e às suas ligações.
+ * 
+ * @param g Pointer para o grafo
+ * @param f Frequência a recalcular
+ * @param removed Vértice acabado de retirar da frequência, ou NULL
+ */
+static void componentRebuild(Graph *g, unsigned char f, Vertex *removed){
+    ComponentSet *set = &g->components;
+    // As componentes de uma frequência só têm membros dessa frequência
+    if (removed != NULL && componentRoot(set, removed->id) == removed->id) set->count--;
+    for (Vertex *m = g->frequencyHead[f]; m != NULL; m = m->freqNext) {
+        if (componentRoot(set, m->id) == m->id) set->count--;
+    }
+    for (Vertex *m = g->frequencyHead[f]; m != NULL; m = m->freqNext) {
+        set->parent[m->id] = m->id;
+        set->size[m->id] = 1;
+        set->count++;
+    }
+    for (Vertex *m = g->frequencyHead[f]; m != NULL; m = m->freqNext) {
+        for (AdjList *adj = m->adjacents; adj != NULL; adj = adj->next) {
+            if (adj->vertex->frequency == m->frequency) componentUnion(set, m->id, adj->vertex->id);
+        }
+    }
+}
+
+/**
+ * @brief Desliga um vértice de todos os adjacentes
+ * 
+ * Retira o nó inverso de cada ligação através do twin, em tempo proporcional ao grau.
+ * 
+ * @param g Pointer para o grafo
+ * @param v Vértice a desligar
+ */
+static void unlinkVertex(Graph *g, Vertex *v){
+    AdjList *adj = v->adjacents;
+    while (adj != NULL) {
+        AdjList *next = adj->next;
+        AdjList *twin = adj->twin;
+        if (twin->prev != NULL) {
+            twin->prev->next = twin->next;
+        } else {
+            adj->vertex->adjacents = twin->next;
+        }
+        if (twin->next != NULL) twin->next->prev = twin->prev;
+        poolRelease(&g->edgePool, twin);
+        poolRelease(&g->edgePool, adj);
+        adj = next;
+    }
+    v->adjacents = NULL;
+}
+
+/**
+ * @brief Aumenta as dimensões da matriz do grafo para incluir uma posição
+ * 
+ * @param g Pointer para o grafo
+ * @param x Linha
+ * @param y Coluna
+ */
+static void growExtent(Graph *g, int x, int y){
+    if (x >= g->rows) g->rows = x + 1;
+    if (y >= g->cols) g->cols = y + 1;
+}
+
+/** 
+ * @brief Adiciona um novo vértice ao grafo e conecta com os da mesma frequência
+ * 
+ * Esta função adiciona o vértice àa lista de vértices do grafo e conecta com arestas 
+ * os outros vértices da mesma frequencia. No modo GRAPH_IMPLICIT as arestas não são
+ * criadas: basta inserir o vértice na lista de membros da sua frequência. No modo
+ * GRAPH_RANGED só é ligado às antenas da mesma frequência dentro dos limites do grafo.
+ * 
+ * @param g Pointer para o grafo
+ * @param x Coordenada X do novo vértice
+ * @param y Coordenada Y do novo vértice
+ * @param frequency Frequência do novo vértice
+ */
+void addVertex(Graph *g, int x, int y, char frequency){
+    INSTRUMENT_FUNCTION();
+    // Cria um novo vértice com as coordenadas e frequência indicadas
+    Vertex *newV = (Vertex*)poolAlloc(&g->vertexPool);
+    if (newV == NULL) return;
+    initVertex(newV, x, y, frequency);
+    // Reutiliza o id de um vértice removido, se houver
+    newV->id = g->freeIdCount > 0 ? g->freeIds[g->freeIdCount - 1] : g->idLimit;
+    if (!componentAdd(&g->components, newV->id)) {
+        poolRelease(&g->vertexPool, newV);
+        return;
+    }
+    if (g->freeIdCount > 0) {
+        g->freeIdCount--;
+    } else {
+        g->idLimit++;
+    }
+    unsigned char f = (unsigned char)frequency;
+
+    // Conectar com vértices da mesma frequência, do mais recente para o mais antigo
+    if (g->mode == GRAPH_EXPLICIT) {
+        Vertex *current = g->frequencyTail[f];
+        while (current != NULL){
+            addEdge(g, newV, current);
+            current = current->freqPrev;
+        }
+    } else if (g->mode == GRAPH_RANGED) {
+        // Só as antenas próximas, encontradas na grelha espacial
+        linkInRange(g, newV, g->frequencyCount[f]);
+        gridInsert(&g->grid, newV);
+    }
+
+    // Inserir no fim da lista de membros da frequência
+    newV->freqPrev = g->frequencyTail[f];
+    if (g->frequencyTail[f] != NULL) {
+        g->frequencyTail[f]->freqNext = newV;
+    } else {
+        g->frequencyHead[f] = newV;
+    }
+    // No modo implícito não há addEdge: a ligação a qualquer membro junta as componentes
+    if (g->mode == GRAPH_IMPLICIT && newV->freqPrev != NULL) {
+        componentUnion(&g->components, newV->id, newV->freqPrev->id);
+    }
+    g->frequencyTail[f] = newV;
+    g->frequencyCount[f]++;
+
+    indexInsert(g, newV);
+
+    // Inserir novo vértice na lista de vértices
+    newV->next = g->vertices;
+    if (g->vertices != NULL) g->vertices->prev = newV;
+    g->vertices = newV;
+    g->vertexCount++;
+    g->version++;
+    growExtent(g, x, y);
+    instrumentCount(INSTRUMENT_VERTICES, 1);
+}
+
+/**
+ * @brief Retira um vértice do índice de coordenadas
+ * 
+ * Com sondagem linear não se pode deixar um buraco no bloco: os vértices seguintes
+ * que deixariam de ser encontrados recuam para a posição libertada.
+ * 
+ * @param index Pointer para o índice
+ * @param v Vértice a retirar
+ */
+static void indexRemove(VertexIndex *index, Vertex *v){
+    if (index->capacity == 0) return;
+    unsigned int mask = (unsigned int)index->capacity - 1;
+    unsigned int slot = indexSlot(v->x, v->y, mask);
+    while (index->slots[slot] != NULL && index->slots[slot] != v) {
+        slot = (slot + 1) & mask;
+    }
+    if (index->slots[slot] == NULL) return;
+
+    unsigned int hole = slot;
+    unsigned int next = (slot + 1) & mask;
+    while (index->slots[next] != NULL) {
+        unsigned int home = indexSlot(index->slots[next]->x, index->slots[next]->y, mask);
+        // Só recua se a posição inicial não estiver entre o buraco e a posição atual
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    index->slots[hole] = NULL;
+    index->count--;
+}
+
+/**
+ * @brief Remove uma antena do grafo
+ * 
+ * Desliga o vértice de cada adjacente através do nó da ligação inversa, pelo que o
+ * custo é proporcional ao grau do vértice. O índice de coordenadas, as listas de membros
+ * da frequência e as componentes ligadas ficam atualizados, e o id do vértice fica livre
+ * para o próximo addVertex.
+ * 
+ * @param g Pointer para o grafo
+ * @param x Coordenada X da antena
+ * @param y Coordenada Y da antena
+ * @param frequency Frequência da antena
+ * @return true se a antena foi removida, false se não existe
+ */
+bool removeVertex(Graph *g, int x, int y, char frequency){
+    INSTRUMENT_FUNCTION();
+    Vertex *v = findVertex(g, x, y, frequency);
+    if (v == NULL) return false;
+    unsigned char f = (unsigned char)frequency;
+
+    // Retira o nó inverso de cada ligação da lista do adjacente
+    unlinkVertex(g, v);
+    if (g->mode == GRAPH_RANGED) gridRemove(&g->grid, v);
+
+    // Retira o vértice da lista de membros da frequência
+    if (v->freqPrev != NULL) {
+        v->freqPrev->freqNext = v->freqNext;
+    } else {
+        g->frequencyHead[f] = v->freqNext;
+    }
+    if (v->freqNext != NULL) {
+        v->freqNext->freqPrev = v->freqPrev;
+    } else {
+        g->frequencyTail[f] = v->freqPrev;
+    }
+    g->frequencyCount[f]--;
+
+    // Nos outros modos todas as antenas da mesma frequência estão ligadas entre si, pelo que
+    // a componente do vértice são os restantes membros (tantos quanto o seu grau): ficam com
+    // nova raiz. Por alcance a componente pode partir-se: refazem-se as da frequência
+    ComponentSet *set = &g->components;
+    Vertex *root = g->frequencyHead[f];
+    if (g->mode == GRAPH_RANGED) {
+        componentRebuild(g, f, v);
+    } else if (root == NULL) {
+        set->count--;
+    } else {
+        for (Vertex *m = root; m != NULL; m = m->freqNext) {
+            set->parent[m->id] = root->id;
+        }
+        set->size[root->id] = g->frequencyCount[f];
+    }
+
+    indexRemove(&g->index, v);
+
+    // Retira o vértice da lista do grafo
+    if (v->prev != NULL) {
+        v->prev->next = v->next;
+    } else {
+        g->vertices = v->next;
+    }
+    if (v->next != NULL) v->next->prev = v->prev;
+    g->vertexCount--;
+    g->version++;
+
+    // Guarda o id para reutilizar; sem memória para isso o id fica simplesmente por usar
+    if (g->freeIdCount == g->freeIdCapacity) {
+        int newCapacity = g->freeIdCapacity > 0 ? g->freeIdCapacity * 2 : 16;
+        int *freeIds = (int*)realloc(g->freeIds, sizeof(int) * newCapacity);
+        if (freeIds != NULL) {
+            g->freeIds = freeIds;
+            g->freeIdCapacity = newCapacity;
+        }
+    }
+    if (g->freeIdCount < g->freeIdCapacity) g->freeIds[g->freeIdCount++] = v->id;
+
+    poolRelease(&g->vertexPool, v);
+    return true;
+}
+
+/**
+ * @brief Muda uma antena de posição, mantendo a frequência e as ligações
+ * 
+ * As ligações dependem apenas da frequência, pelo que só o índice de coordenadas
+ * precisa de ser atualizado; o vértice mantém a sua posição na lista do grafo.
+ * No modo GRAPH_RANGED as ligações dependem da posição: o vértice é desligado e
+ * volta a ser ligado às antenas próximas do destino, e as componentes da frequência
+ * são recalculadas.
+ * 
+ * @param g Pointer para o grafo
+ * @param x Coordenada X atual da antena
+ * @param y Coordenada Y atual da antena
+ * @param frequency Frequência da antena
+ * @param newX Nova coordenada X
+ * @param newY Nova coordenada Y
+ * @return true se a antena foi movida, false se não existe, se já existe uma antena da
+ *         mesma frequência no destino ou se faltou memória
+ */
+bool moveVertex(Graph *g, int x, int y, char frequency, int newX, int newY){
+    INSTRUMENT_FUNCTION();
+    Vertex *v = findVertex(g, x, y, frequency);
+    if (v == NULL) return false;
+    if (newX == x && newY == y) return true;
+    if (findVertex(g, newX, newY, frequency) != NULL) return false;
+
+    if (g->mode == GRAPH_RANGED) {
+        unlinkVertex(g, v);
+        gridRemove(&g->grid, v);
+    }
+    indexRemove(&g->index, v);
+    v->x = newX;
+    v->y = newY;
+    bool moved = indexInsert(g, v);
+    if (!moved) {
+        // Sem memória para aumentar o índice: repõe a posição antiga
+        v->x = x;
+        v->y = y;
+        indexInsert(g, v);
+    } else {
+        growExtent(g, newX, newY);
+    }
+    if (g->mode == GRAPH_RANGED) {
+        unsigned char f = (unsigned char)frequency;
+        linkInRange(g, v, g->frequencyCount[f] - 1);
+        gridInsert(&g->grid, v);
+        componentRebuild(g, f, NULL);
+    }
+    // Mesmo sem mover, o modo por alcance voltou a criar as ligações
+    g->version++;
+    return moved;
+}
+
+/**
+ * @brief Inicia a iteração sobre os adjacentes de um vértice
+ * 
+ * @param g Pointer para o grafo
+ * @param v Vértice cujos adjacentes vão ser percorridos
+ * @param c Cursor a inicializar
+ */
+void beginNeighbors(Graph *g, Vertex *v, NeighborCursor *c){
+    if (g->mode != GRAPH_IMPLICIT) {
+        c->adj = v->adjacents;
+        c->member = NULL;
+        c->phase = 2;
+        return;
+    }
+    c->adj = NULL;
+    // Começa pelos membros mais recentes da frequência
+    c->member = g->frequencyTail[(unsigned char)v->frequency];
+    c->phase = 0;
+}
+
+/**
+ * @brief Devolve o próximo adjacente de um vértice
+ * 
+ * No modo implícito os adjacentes são todos os outros membros da frequência,
+ * pela mesma ordem em que ficariam na lista AdjList do modo explícito.
+ * 
+ * @param g Pointer para o grafo
+ * @param v Vértice cujos adjacentes estão a ser percorridos
+ * @param c Cursor iniciado pelo beginNeighbors
+ * @return Vertex* Próximo adjacente, ou NULL quando não há mais
+ */
+Vertex *nextNeighbor(Graph *g, Vertex *v, NeighborCursor *c){
+    if (g->mode != GRAPH_IMPLICIT) {
+        if (c->adj == NULL) return NULL;
+        Vertex *neighbor = c->adj->vertex;
+        c->adj = c->adj->next;
+        return neighbor;
+    }
+
+    if (c->phase == 0) {
+        // Membros mais recentes, do mais recente até ao próprio vértice (exclusive)
+        if (c->member != v) {
+            Vertex *neighbor = c->member;
+            c->member = c->member->freqPrev;
+            return neighbor;
+        }
+        c->phase = 1;
+        c->member = g->frequencyHead[(unsigned char)v->frequency];
+    }
+    if (c->phase == 1) {
+        // Membros mais antigos, do mais antigo até ao próprio vértice (exclusive)
+        if (c->member != v) {
+            Vertex *neighbor = c->member;
+            c->member = c->member->freqNext;
+            return neighbor;
+        }
+        c->phase = 2;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Percorre o grafo, entregando cada vértice e as suas ligações
+ * 
+ * Para cada vértice, pela ordem da lista do grafo, chama visitVertex e depois visitEdge
+ * para cada um dos seus adjacentes, pela ordem da lista de adjacência.
+ * 
+ * @param g Pointer para grafo
+ * @param visitVertex Função chamada para cada vértice (pode ser NULL)
+ * @param visitEdge Função chamada para cada ligação (pode ser NULL)
+ * @param userData Pointer passado sem alterações às duas funções
+ */
+void visitGraph(Graph* g, VertexVisitor visitVertex, EdgeVisitor visitEdge, void *userData) {
+    INSTRUMENT_FUNCTION();
+    // Variável auxiliar para percorrer todos os vértices do grafo
+    Vertex *v = g->vertices;
+    while (v != NULL) {
+        if (visitVertex != NULL) visitVertex(v, userData);
+        if (visitEdge != NULL) {
+            // Cursor auxiliar para percorrer todas as adjaacentes dos vértices
+            NeighborCursor c;
+            beginNeighbors(g, v, &c);
+            Vertex *adj;
+            while ((adj = nextNeighbor(g, v, &c)) != NULL) {
+                visitEdge(v, adj, userData);
+            }
+        }
+        v = v->next;
+    }
+}
+
+/**
+ * @brief Imprime o conteúdo do grafo
+ * 
+ * Função para imprimir todos os vértices do grafo, assinalando as coordenadas
+ * e frequencia, bem como os vértices adjacentes.
+ * 
+ * @param g Pointer para grafo
+ */
+void printGraph(Graph* g) {
+    INSTRUMENT_FUNCTION();
+    OutputWriter *w = createOutputWriter(stdout, OUTPUT_TEXT);
+    if (w == NULL) return;
+    writeGraph(w, g);
+    freeOutputWriter(w);
+}
+
+/**
+ * @brief Hash FNV-1a das células de uma linha do ficheiro de texto
+ * 
+ * Só entram os carácteres que o leitor conta como células (sem espaços, tabs nem o '\n'),
+ * pelo que duas linhas com o mesmo hash têm, com grande probabilidade, as mesmas antenas.
+ * 
+ * @param line Linha lida pelo getline
+ * @return uint64_t Hash da linha
+ */
+static uint64_t rowHash(const char *line){
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; line[i] != '\0' && line[i] != '\n'; i++) {
+        if (line[i] == ' ' || line[i] == '\t') continue;
+        hash = (hash ^ (unsigned char)line[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Guarda o hash de uma linha no RowDigest do grafo
+ * 
+ * @param digest Pointer para os hashes das linhas
+ * @param row Linha (as linhas são guardadas por ordem, a partir de 0)
+ * @param hash Hash da linha
+ * @return true se o hash foi guardado, false se faltou memória
+ */
+static bool digestSet(RowDigest *digest, int row, uint64_t hash){
+    if (row >= digest->capacity) {
+        int newCapacity = digest->capacity > 0 ? digest->capacity * 2 : 64;
+        while (newCapacity <= row) newCapacity *= 2;
+        uint64_t *hashes = (uint64_t*)realloc(digest->hashes, sizeof(uint64_t) * newCapacity);
+        if (hashes == NULL) return false;
+        digest->hashes = hashes;
+        digest->capacity = newCapacity;
+    }
+    digest->hashes[row] = hash;
+    if (row >= digest->count) digest->count = row + 1;
+    return true;
+}
+
+/**
+ * @brief Acrescenta a um grafo vazio as antenas de um ficheiro de texto
+ * 
+ * @param filename Nome de ficheiro de texto a ser lido
+ * @param g Grafo criado pela função que chama (libertado se o ficheiro não abrir)
+ * @return Graph* O próprio grafo, ou NULL se não existe ou o ficheiro não abriu
+ */
+static Graph *readGraphText(const char *filename, Graph *g){
+    if (g == NULL) return NULL;
+    FILE *file = fopen(filename, "r");
+    if (file == NULL){
+        freeGraph(g);
+        return NULL;
+    }
+
+    char *line = NULL; // Pointer que vai guardar cada linha lida
+    size_t len = 0;    // Tamanho do buffer (é ajustado automaticamente pelo getline)
+    int x = 0;
+    bool digestOk = true; // Hashes das linhas, para o reloadGraphFromFile
+
+  //lê cada linha até ao final do ficheiro
+  ssize_t lineLength;
+  while ((lineLength = getline(&line, &len, file)) != -1) {
+        instrumentCount(INSTRUMENT_BYTES_READ, (unsigned long long)lineLength);
+        int y = 0; // Agora y representa a coluna
+        for (int i = 0; line[i] != '\0'; i++) {
+            // Ignora espaços ou tabs
+            if (line[i] == ' ' || line[i] == '\t') continue;
+
+            // '.' representa célula vazia, ignora
+            if (line[i] != '.' && line[i] != '\n') {
+                // Troca x e y na chamada
+                addVertex(g, x, y, line[i]);
+            }
+            y++;
+        }
+        // O '\n' também avançou o y
+        growExtent(g, x, y - (lineLength > 0 && line[lineLength - 1] == '\n' ? 2 : 1));
+        digestOk = digestOk && digestSet(&g->rowDigest, x, rowHash(line));
+        x++;
+    }
+
+    free(line);
+    fclose(file);
+    // Sem todos os hashes, o reloadGraphFromFile compara todas as linhas
+    if (!digestOk) g->rowDigest.count = 0;
+    g->rowDigest.version = g->version;
+    return g;
+}
+
+/**
+ * @brief Lê um grafo de um ficheiro de texto
+ * 
+ * Esta função lê cada linha do ficheiro, interpreta caracteres diferentes de '.' como antenas,
+ * e insere um vértice com a frequência correspondente e as respetivas coordenadas (linha, coluna).
+ * Cada antena é adicionada ao grafo como um novo vértice.
+ * 
+ * @param filename Nome de ficheiro de texto a ser lido
+ * @return Graph* Pointer para o grafo construído
+ */
+Graph *readGraphFromFile(const char *filename){
+    INSTRUMENT_FUNCTION();
+    return readGraphFromFileWithMode(filename, GRAPH_EXPLICIT);
+}
+
+/**
+ * @brief Lê um grafo de um ficheiro de texto com a representação de ligações indicada
+ * 
+ * @param filename Nome de ficheiro de texto a ser lido
+ * @param mode Representação das ligações da mesma frequência
+ * @return Graph* Pointer para o grafo construído
+ */
+Graph *readGraphFromFileWithMode(const char *filename, GraphMode mode){
+    INSTRUMENT_FUNCTION();
+    return readGraphText(filename, createGraphWithMode(mode));
+}
+
+/**
+ * @brief Lê um grafo de um ficheiro de texto, ligando só as antenas próximas
+ * 
+ * @param filename Nome de ficheiro de texto a ser lido
+ * @param radius Distância máxima das ligações, ou 0 para não limitar a distância
+ * @param nearest Número máximo de ligações criadas por cada nova antena, ou 0 para não limitar
+ * @return Graph* Pointer para o grafo construído (ver createGraphWithRange)
+ */
+Graph *readGraphFromFileWithRange(const char *filename, int radius, int nearest){
+    INSTRUMENT_FUNCTION();
+    return readGraphText(filename, createGraphWithRange(radius, nearest));
+}
+
+/**
+ * @brief Primeira antena de uma posição com frequência diferente da indicada
+ * 
+ * @param g Pointer para o grafo
+ * @param x Coordenada X
+ * @param y Coordenada Y
+ * @param frequency Frequência a manter, ou '\0' para devolver qualquer antena da posição
+ * @return Vertex* Antena, ou NULL se não há outras antenas na posição
+ */
+static Vertex *findOtherAt(Graph *g, int x, int y, char frequency){
+    if (g->index.capacity == 0) return NULL;
+    unsigned int mask = (unsigned int)g->index.capacity - 1;
+    unsigned int slot = indexSlot(x, y, mask);
+    Vertex *v;
+    while ((v = g->index.slots[slot]) != NULL) {
+        if (v->x == x && v->y == y && v->frequency != frequency) return v;
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Deixa numa posição do grafo só a antena indicada pelo ficheiro
+ * 
+ * @param g Pointer para o grafo
+ * @param x Coordenada X
+ * @param y Coordenada Y
+ * @param frequency Frequência da antena da posição, ou '\0' se a posição está vazia
+ * @param stats Contadores das alterações
+ */
+static void reloadCell(Graph *g, int x, int y, char frequency, ReloadStats *stats){
+    int removed = 0;
+    Vertex *v;
+    while ((v = findOtherAt(g, x, y, frequency)) != NULL) {
+        removeVertex(g, x, y, v->frequency);
+        removed++;
+    }
+    bool added = false;
+    if (frequency != '\0' && findVertex(g, x, y, frequency) == NULL) {
+        addVertex(g, x, y, frequency);
+        added = findVertex(g, x, y, frequency) != NULL;
+    }
+
+    // Uma antena trocada por outra na mesma posição conta como mudança de frequência
+    if (added && removed > 0) {
+        stats->changed++;
+        removed--;
+        added = false;
+    }
+    stats->removed += removed;
+    if (added) stats->added++;
+}
+
+/**
+ * @brief Compara uma linha do ficheiro com o grafo, célula a célula, e aplica as diferenças
+ * 
+ * @param g Pointer para o grafo
+ * @param x Linha
+ * @param line Linha lida pelo getline ("" para uma linha que deixou de existir)
+ * @param oldCols Colunas da matriz antes da nova leitura: as células da linha para lá
+ *        do fim da nova linha ficam vazias
+ * @param stats Contadores das alterações
+ */
+static void reloadRow(Graph *g, int x, const char *line, int oldCols, ReloadStats *stats){
+    int y = 0;
+    for (int i = 0; line[i] != '\0' && line[i] != '\n'; i++) {
+        if (line[i] == ' ' || line[i] == '\t') continue;
+        reloadCell(g, x, y, line[i] == '.' ? '\0' : line[i], stats);
+        y++;
+    }
+    for (; y < oldCols; y++) {
+        reloadCell(g, x, y, '\0', stats);
+    }
+    stats->rowsCompared++;
+}
+
+/**
+ * @brief Atualiza um grafo com as alterações de um ficheiro de texto, sem o reconstruir
+ * 
+ * Compara o ficheiro com o grafo e aplica só as diferenças: antenas novas (addVertex),
+ * antenas retiradas (removeVertex) e mudanças de frequência. As linhas com o mesmo hash
+ * da última leitura (readGraphFromFile ou reloadGraphFromFile) são saltadas; as restantes
+ * são comparadas célula a célula. O ficheiro é sempre lido todo, mas o trabalho sobre o
+ * grafo é proporcional às diferenças. Se o grafo foi alterado depois da última leitura,
+ * ou não veio de um ficheiro de texto, todas as linhas são comparadas. No fim o grafo
+ * tem as mesmas antenas que o readGraphFromFile daria, mas a ordem dos vértices e das
+ * listas de adjacência pode ser outra.
+ * 
+ * @param g Pointer para o grafo
+ * @param filename Nome de ficheiro de texto a ser lido
+ * @param stats Recebe o número de alterações aplicadas (pode ser NULL)
+ * @return true se o ficheiro foi lido, false se não abriu (o grafo fica igual)
+ */
+bool reloadGraphFromFile(Graph *g, const char *filename, ReloadStats *stats){
+    INSTRUMENT_FUNCTION();
+    if (g == NULL) return false;
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) return false;
+
+    ReloadStats counts;
+    memset(&counts, 0, sizeof(counts));
+    RowDigest *digest = &g->rowDigest;
+    // Os hashes guardados só descrevem o grafo se não foi alterado depois da última leitura
+    int trustedRows = digest->version == g->version ? digest->count : 0;
+    int oldRows = g->rows;
+    int oldCols = g->cols;
+    int rows = 0, cols = 0;
+    bool digestOk = true;
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t lineLength;
+    while ((lineLength = getline(&line, &len, file)) != -1) {
+        instrumentCount(INSTRUMENT_BYTES_READ, (unsigned long long)lineLength);
+        int x = rows++;
+        uint64_t hash = rowHash(line);
+        if (x < trustedRows && digest->hashes[x] == hash) {
+            counts.rowsSkipped++;
+        } else {
+            reloadRow(g, x, line, oldCols, &counts);
+        }
+        digestOk = digestOk && digestSet(digest, x, hash);
+
+        // Largura da linha contada como no readGraphFromFile
+        int width = 0;
+        for (int i = 0; line[i] != '\0' && line[i] != '\n'; i++) {
+            if (line[i] != ' ' && line[i] != '\t') width++;
+        }
+        if (width > cols) cols = width;
+    }
+    free(line);
+    fclose(file);
+
+    // Linhas que deixaram de existir
+    for (int x = rows; x < oldRows; x++) {
+        reloadRow(g, x, "", oldCols, &counts);
+    }
+
+    g->rows = rows;
+    g->cols = cols;
+    digest->count = digestOk ? rows : 0;
+    digest->version = g->version;
+    if (stats != NULL) *stats = counts;
+    return true;
+}
+
+
+/**
+ * @struct MappedChunk
+ * @brief Bloco de linhas completas do ficheiro mapeado, processado por uma thread.
+ */
+typedef struct MappedChunk{
+    const char *begin; // Primeiro carácter do bloco (início de uma linha)
+    const char *end; // Fim do bloco (depois de um '\n' ou fim do ficheiro)
+    int rows; // Número de linhas encontradas no bloco
+    int cols; // Número de células da linha mais comprida do bloco
+    AntennaCell *cells; // Antenas encontradas, com x relativo ao início do bloco
+    int cellCount;
+    int cellCapacity;
+    bool failed; // true se faltou memória
+} MappedChunk;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/**
+ * @brief Marca (bit mais alto de cada byte) os bytes de uma palavra iguais a c
+ * 
+ * @param w 8 bytes do ficheiro
+ * @param c Carácter a procurar
+ * @return uint64_t 0x80 nos bytes iguais a c, 0 nos restantes
+ */
+static inline uint64_t bytesEqual(uint64_t w, unsigned char c){
+    uint64_t x = w ^ (0x0101010101010101ULL * c);
+    uint64_t t = ((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x;
+    return ~t & 0x8080808080808080ULL;
+}
+#endif
+
+/**
+ * @brief Guarda uma antena encontrada num bloco
+ * 
+ * @param chunk Bloco a ser processado
+ * @param x Linha relativa ao início do bloco
+ * @param y Coluna da antena
+ * @param frequency Frequência da antena
+ */
+static void chunkAddCell(MappedChunk *chunk, int x, int y, char frequency){
+    if (chunk->cellCount == chunk->cellCapacity) {
+        int newCapacity = chunk->cellCapacity > 0 ? chunk->cellCapacity * 2 : 256;
+        AntennaCell *cells = (AntennaCell*)realloc(chunk->cells, sizeof(AntennaCell) * newCapacity);
+        if (cells == NULL) {
+            chunk->failed = true;
+            return;
+        }
+        chunk->cells = cells;
+        chunk->cellCapacity = newCapacity;
+    }
+    chunk->cells[chunk->cellCount].x = x;
+    chunk->cells[chunk->cellCount].y = y;
+    chunk->cells[chunk->cellCount].frequency = frequency;
+    chunk->cellCount++;
+}
+
+/**
+ * @brief Procura as antenas de um bloco de linhas do ficheiro mapeado
+ * 
+ * Segue a mesma convenção do readGraphFromFile: x é a linha, y é a coluna sem contar
+ * espaços e tabs, '.' é uma célula vazia. As sequências de '.', espaços e tabs são
+ * saltadas 8 bytes de cada vez, contando apenas os '.' para avançar a coluna.
+ * 
+ * @param arg Pointer para o MappedChunk a processar
+ * @return void* NULL
+ */
+static void *parseMappedChunk(void *arg){
+    MappedChunk *chunk = (MappedChunk*)arg;
+    const char *p = chunk->begin;
+    int x = 0;
+
+    while (p < chunk->end && !chunk->failed) {
+        const char *lineEnd = (const char*)memchr(p, '\n', chunk->end - p);
+        if (lineEnd == NULL) lineEnd = chunk->end;
+
+        int y = 0;
+        while (p < lineEnd) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            if (lineEnd - p >= 8) {
+                uint64_t w;
+                memcpy(&w, p, sizeof(w));
+                uint64_t dots = bytesEqual(w, '.');
+                uint64_t blanks = bytesEqual(w, ' ') | bytesEqual(w, '\t');
+                uint64_t antennas = ~(dots | blanks) & 0x8080808080808080ULL;
+
+                if (antennas == 0) {
+                    // 8 células vazias ou espaços seguidos
+                    y += __builtin_popcountll(dots);
+                    p += 8;
+                    continue;
+                }
+
+                // Salta o que está antes da primeira antena da palavra
+                int skip = __builtin_ctzll(antennas) / 8;
+                if (skip > 0) {
+                    y += __builtin_popcountll(dots & ((1ULL << (8 * skip)) - 1));
+                    p += skip;
+                }
+            }
+#endif
+            char c = *p++;
+            if (c == ' ' || c == '\t') continue;
+            if (c != '.') {
+                chunkAddCell(chunk, x, y, c);
+            }
+            y++;
+        }
+
+        if (y > chunk->cols) chunk->cols = y;
+        x++;
+        p = lineEnd + 1;
+    }
+
+    chunk->rows = x;
+    return NULL;
+}
+
+/**
+ * @struct FrequencyBuild
+ * @brief Estado partilhado pelas threads do buildGraphParallel.
+ */
+typedef struct FrequencyBuild{
+    Vertex **members; // Vértices agrupados por frequência, cada grupo pela ordem de inserção
+    int start[FREQUENCY_COUNT + 1]; // Início do grupo de cada frequência em members
+    unsigned char order[FREQUENCY_COUNT]; // Frequências com ligações, da que tem mais para a que tem menos
+    int orderCount;
+    int next; // Próxima frequência por atribuir (incrementada atomicamente)
+} FrequencyBuild;
+
+/**
+ * @struct FrequencyWorker
+ * @brief Thread do buildGraphParallel, com o seu próprio pool de nós AdjList.
+ */
+typedef struct FrequencyWorker{
+    FrequencyBuild *build;
+    NodePool pool;
+    bool failed; // true se faltou memória
+} FrequencyWorker;
+
+/**
+ * @brief Ciclo de uma thread do buildGraphParallel: liga as frequências até não haver mais
+ * 
+ * Cada frequência é tratada por uma única thread e as ligações nunca saem da frequência,
+ * pelo que as threads nunca alteram o mesmo vértice.
+ * 
+ * @param arg Pointer para o FrequencyWorker
+ * @return void* NULL
+ */
+static void *frequencyWorker(void *arg){
+    FrequencyWorker *w = (FrequencyWorker*)arg;
+    FrequencyBuild *b = w->build;
+    int i;
+    while (!w->failed && (i = __atomic_fetch_add(&b->next, 1, __ATOMIC_RELAXED)) < b->orderCount) {
+        unsigned char f = b->order[i];
+        Vertex **members = b->members + b->start[f];
+        int count = b->start[f + 1] - b->start[f];
+        // A mesma sequência do addVertex: cada membro liga-se aos anteriores, do mais recente
+        // para o mais antigo, o que dá listas de adjacência pela mesma ordem
+        for (int k = 1; k < count && !w->failed; k++) {
+            for (int j = k - 1; j >= 0; j--) {
+                if (!linkVertices(&w->pool, members[k], members[j])) {
+                    w->failed = true;
+                    break;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Constrói um grafo a partir de uma lista de antenas, ligando cada frequência numa thread
+ * 
+ * O resultado é igual ao de chamar addVertex para cada antena, pela ordem do array: os
+ * vértices, o índice, as listas de membros e as componentes são criados pela thread atual,
+ * e as ligações de cada frequência são criadas em paralelo, cada thread no seu próprio pool,
+ * que no fim passa para o pool de arestas do grafo. No modo GRAPH_RANGED o grafo é
+ * construído em série com o addVertex.
+ * 
+ * @param cells Antenas a inserir, pela ordem de inserção
+ * @param count Número de antenas
+ * @param mode Representação das ligações da mesma frequência
+ * @param threadCount Número máximo de threads, ou 0 para usar todos os processadores
+ * @return Graph* Pointer para o grafo construído, ou NULL se faltou memória
+ */
+Graph *buildGraphParallel(const AntennaCell *cells, int count, GraphMode mode, int threadCount){
+    INSTRUMENT_FUNCTION();
+    Graph *g = createGraphWithMode(mode);
+    if (g == NULL || count <= 0) return g;
+    if (mode == GRAPH_RANGED) {
+        // As ligações por alcance dependem das antenas já inseridas: constrói em série
+        for (int i = 0; i < count; i++) {
+            addVertex(g, cells[i].x, cells[i].y, cells[i].frequency);
+        }
+        return g;
+    }
+
+    FrequencyBuild *b = (FrequencyBuild*)calloc(1, sizeof(FrequencyBuild));
+    if (b != NULL) b->members = (Vertex**)malloc(sizeof(Vertex*) * count);
+    if (b == NULL || b->members == NULL) {
+        free(b);
+        freeGraph(g);
+        return NULL;
+    }
+
+    // Vértices pela ordem das antenas, tal como no addVertex
+    bool failed = false;
+    for (int i = 0; i < count && !failed; i++) {
+        Vertex *v = (Vertex*)poolAlloc(&g->vertexPool);
+        if (v == NULL || !componentAdd(&g->components, i)) {
+            failed = true;
+            break;
+        }
+        initVertex(v, cells[i].x, cells[i].y, cells[i].frequency);
+        v->id = i;
+        g->idLimit = i + 1;
+        unsigned char f = (unsigned char)cells[i].frequency;
+
+        v->freqPrev = g->frequencyTail[f];
+        if (g->frequencyTail[f] != NULL) {
+            g->frequencyTail[f]->freqNext = v;
+            // Junta-se à componente da frequência, como o primeiro addEdge do addVertex
+            componentUnion(&g->components, v->id, v->freqPrev->id);
+        } else {
+            g->frequencyHead[f] = v;
+        }
+        g->frequencyTail[f] = v;
+        g->frequencyCount[f]++;
+
+        if (!indexInsert(g, v)) failed = true;
+        growExtent(g, v->x, v->y);
+        v->next = g->vertices;
+        if (g->vertices != NULL) g->vertices->prev = v;
+        g->vertices = v;
+        g->vertexCount++;
+        g->version++;
+    }
+    instrumentCount(INSTRUMENT_VERTICES, (unsigned long long)g->vertexCount);
+
+    if (!failed && mode == GRAPH_EXPLICIT) {
+        // Agrupa os membros por frequência e ordena as frequências pelo número de ligações
+        long long links = 0;
+        int position = 0;
+        for (int f = 0; f < FREQUENCY_COUNT; f++) {
+            b->start[f] = position;
+            for (Vertex *v = g->frequencyHead[f]; v != NULL; v = v->freqNext) {
+                b->members[position++] = v;
+            }
+            int members = g->frequencyCount[f];
+            if (members < 2) continue;
+            links += (long long)members * (members - 1) / 2;
+            int k = b->orderCount++;
+            while (k > 0 && g->frequencyCount[b->order[k - 1]] < members) {
+                b->order[k] = b->order[k - 1];
+                k--;
+            }
+            b->order[k] = (unsigned char)f;
+        }
+        b->start[FREQUENCY_COUNT] = position;
+
+        if (threadCount <= 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            threadCount = cpus > 0 ? (int)cpus : 1;
+        }
+        if (threadCount > b->orderCount) threadCount = b->orderCount;
+        if (links < PARALLEL_BUILD_MIN_LINKS || threadCount < 1) threadCount = 1;
+
+        FrequencyWorker *workers = (FrequencyWorker*)calloc(threadCount, sizeof(FrequencyWorker));
+        pthread_t *threads = (pthread_t*)malloc(sizeof(pthread_t) * threadCount);
+        bool *started = (bool*)calloc(threadCount, sizeof(bool));
+        if (workers == NULL || threads == NULL || started == NULL) {
+            failed = true;
+        } else {
+            for (int i = 0; i < threadCount; i++) {
+                workers[i].build = b;
+                poolInit(&workers[i].pool, sizeof(AdjList));
+            }
+            // A thread atual é o primeiro worker; se uma thread não arrancar, as outras fazem o trabalho
+            for (int i = 1; i < threadCount; i++) {
+                started[i] = pthread_create(&threads[i], NULL, frequencyWorker, &workers[i]) == 0;
+            }
+            frequencyWorker(&workers[0]);
+            for (int i = 1; i < threadCount; i++) {
+                if (started[i]) pthread_join(threads[i], NULL);
+            }
+            for (int i = 0; i < threadCount; i++) {
+                failed = failed || workers[i].failed;
+                poolMerge(&g->edgePool, &workers[i].pool);
+            }
+        }
+        free(workers);
+        free(threads);
+        free(started);
+    }
+
+    free(b->members);
+    free(b);
+    if (failed) {
+        freeGraph(g);
+        return NULL;
+    }
+    return g;
+}
+
+/**
+ * @brief Lê um grafo de um ficheiro de texto mapeado em memória
+ * 
+ * Alternativa de alto débito ao readGraphFromFile para ficheiros muito grandes: o ficheiro
+ * é mapeado com mmap, dividido em blocos de linhas completas e cada bloco é processado
+ * por uma thread. No fim, o buildGraphParallel insere as antenas pela mesma ordem do
+ * readGraphFromFile, pelo que o grafo resultante é idêntico.
+ * 
+ * @param filename Nome de ficheiro de texto a ser lido
+ * @param mode Representação das ligações da mesma frequência
+ * @param threadCount Número máximo de threads, ou 0 para usar todos os processadores
+ * @return Graph* Pointer para o grafo construído, ou NULL em caso de erro
+ */
+Graph *readGraphFromFileMapped(const char *filename, GraphMode mode, int threadCount){
+    INSTRUMENT_FUNCTION();
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    instrumentCount(INSTRUMENT_BYTES_READ, size);
+    if (size == 0) {
+        close(fd);
+        return createGraphWithMode(mode);
+    }
+
+    const char *data = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    // Número de blocos: limitado pelas threads e por um tamanho mínimo por bloco
+    if (threadCount <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = cpus > 0 ? (int)cpus : 1;
+    }
+    size_t maxChunks = size / MAPPED_CHUNK_MIN + 1;
+    int chunkCount = (size_t)threadCount < maxChunks ? threadCount : (int)maxChunks;
+
+    MappedChunk *chunks = (MappedChunk*)calloc(chunkCount, sizeof(MappedChunk));
+    if (chunks == NULL) {
+        munmap((void*)data, size);
+        return NULL;
+    }
+
+    // Divide o ficheiro em blocos que começam sempre no início de uma linha
+    const char *fileEnd = data + size;
+    const char *p = data;
+    for (int i = 0; i < chunkCount; i++) {
+        chunks[i].begin = p;
+        const char *target = data + size / chunkCount * (i + 1);
+        if (i == chunkCount - 1 || target >= fileEnd) {
+            p = fileEnd;
+        } else if (target > p) {
+            const char *nl = (const char*)memchr(target, '\n', fileEnd - target);
+            p = nl != NULL ? nl + 1 : fileEnd;
+        }
+        chunks[i].end = p;
+    }
+
+    // Cada bloco é processado numa thread (o primeiro na thread atual)
+    pthread_t *threads = (pthread_t*)malloc(sizeof(pthread_t) * chunkCount);
+    bool *started = (bool*)calloc(chunkCount, sizeof(bool));
+    for (int i = 1; i < chunkCount; i++) {
+        if (threads != NULL && started != NULL &&
+            pthread_create(&threads[i], NULL, parseMappedChunk, &chunks[i]) == 0) {
+            started[i] = true;
+        } else {
+            parseMappedChunk(&chunks[i]);
+        }
+    }
+    parseMappedChunk(&chunks[0]);
+    for (int i = 1; i < chunkCount; i++) {
+        if (started != NULL && started[i]) pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    free(started);
+
+    // Junta as antenas pela ordem do ficheiro, com x relativo ao início do ficheiro
+    bool failed = false;
+    int total = 0;
+    for (int i = 0; i < chunkCount; i++) {
+        failed = failed || chunks[i].failed;
+        total += chunks[i].cellCount;
+    }
+    AntennaCell *cells = failed ? NULL : (AntennaCell*)malloc(sizeof(AntennaCell) * (total > 0 ? total : 1));
+    int rowBase = 0, position = 0, cols = 0;
+    for (int i = 0; i < chunkCount; i++) {
+        if (chunks[i].cols > cols) cols = chunks[i].cols;
+        for (int c = 0; c < chunks[i].cellCount && cells != NULL; c++) {
+            cells[position] = chunks[i].cells[c];
+            cells[position].x += rowBase;
+            position++;
+        }
+        rowBase += chunks[i].rows;
+        free(chunks[i].cells);
+    }
+    free(chunks);
+    munmap((void*)data, size);
+
+    // As ligações de cada frequência são criadas em paralelo
+    Graph *g = cells != NULL ? buildGraphParallel(cells, total, mode, threadCount) : NULL;
+    if (g != NULL) growExtent(g, rowBase - 1, cols - 1);
+    free(cells);
+    return g;
+}
+
+/**
+ * @brief Escreve um grafo para um ficheiro binário.
  * 
  * Esta função guarda todos os vértices e as suas adjacências num ficheiro binário,
  * no seguinte formato: número total de vértices, dados de cada vértice (coordenadas x, y e frequência),
  * seguido pelo número de adjacências e as coordenadas de cada vértice adjacente.
  * 
- * @param filename Nome do ficheiro binário do grafo que será escrito.
- * @param g Pointer para o grafo a ser escrito.
+ * @param filename Nome do ficheiro binário do grafo que será escrito.
+ * @param g Pointer para o grafo a ser escrito.
+ */
+void writeGraphToBinary(const char *filename, Graph *g) {
+    INSTRUMENT_FUNCTION();
+    FILE *f = fopen(filename, "wb");
+    if (!f) return;
+
+    // Conta vértices
+    int vertexCount = 0;
+    Vertex *v = g->vertices;
+    while (v) {
+        vertexCount++;
+        v = v->next;
+    }
+    
+    //parametros da fwrite e fread (*ptr, size_t size, size_t count, file *stream)
+    fwrite(&vertexCount, sizeof(int), 1, f);
+
+    // Escreve vértices
+    v = g->vertices;
+    while (v) {
+        fwrite(&v->x, sizeof(int), 1, f);
+        fwrite(&v->y, sizeof(int), 1, f);
+        fwrite(&v->frequency, sizeof(char), 1, f);
+        v = v->next;
+    }
+
+    // Escreve adjacências (coordenadas dos vértices adjacentes)
+    v = g->vertices;
+    while (v) {
+        // Conta adjacentes
+        int adjCount = 0;
+        NeighborCursor c;
+        beginNeighbors(g, v, &c);
+        while (nextNeighbor(g, v, &c) != NULL) {
+            adjCount++;
+        }
+        fwrite(&adjCount, sizeof(int), 1, f);
+
+        // Escrever adjacentes (coordenadas)
+        beginNeighbors(g, v, &c);
+        Vertex *adj;
+        while ((adj = nextNeighbor(g, v, &c)) != NULL) {
+            int x = adj->x;
+            int y = adj->y;
+            fwrite(&x, sizeof(int), 1, f);
+            fwrite(&y, sizeof(int), 1, f);
+        }
+        v = v->next;
+    }
+
+    long written = ftell(f);
+    if (written > 0) instrumentCount(INSTRUMENT_BYTES_WRITTEN, (unsigned long long)written);
+    fclose(f);
+}
+
+/**
+ * @brief Lê um grafo a partir de um ficheiro binário.
+ * 
+ * Esta função reconstrói um grafo previamente guardado em formato binário, criando os vértices
+ * e estabelecendo as adjacências com base nas coordenadas guardadas.
+ * 
+ * @param filename Nome do ficheiro binário de onde o grafo será lido.
+ * @return Pointer para o grafo reconstruído. Retorna NULL em caso de erro na leitura.
+ */
+Graph *readGraphFromBinary(const char *filename) {
+    INSTRUMENT_FUNCTION();
+    return readGraphFromBinaryWithMode(filename, GRAPH_EXPLICIT);
+}
+
+/**
+ * @brief Lê um grafo a partir de um ficheiro binário com a representação de ligações indicada
+ * 
+ * @param filename Nome do ficheiro binário de onde o grafo será lido.
+ * @param mode Representação das ligações da mesma frequência
+ * @return Pointer para o grafo reconstruído. Retorna NULL em caso de erro na leitura.
+ */
+Graph *readGraphFromBinaryWithMode(const char *filename, GraphMode mode) {
+    INSTRUMENT_FUNCTION();
+    FILE *f = fopen(filename, "rb");
+    if (!f) return NULL;
+
+    Graph *g = createGraphWithMode(mode);
+
+    int vertexCount = 0;
+    fread(&vertexCount, sizeof(int), 1, f);
+
+    // Frequência de cada vértice pela ordem do ficheiro, para validar as adjacências
+    char *frequencies = (char*)malloc(sizeof(char) * (vertexCount > 0 ? vertexCount : 1));
+    if (frequencies == NULL) {
+        fclose(f);
+        freeGraph(g);
+        return NULL;
+    }
+
+    // Criar todos os vértices e inserir no grafo
+    for (int i = 0; i < vertexCount; i++) {
+        int x, y;
+        char freq;
+        fread(&x, sizeof(int), 1, f);
+        fread(&y, sizeof(int), 1, f);
+        fread(&freq, sizeof(char), 1, f);
+        frequencies[i] = freq;
+        addVertex(g, x, y, freq);  // adiciona já ao grafo
+    }
+
+    // Agora ler as adjacências: o addVertex já ligou os vértices, por isso
+    // cada adjacência serve apenas para confirmar que o ficheiro é coerente
+    bool valid = true;
+    for (int i = 0; i < vertexCount && valid; i++) {
+        int adjCount = 0;
+        fread(&adjCount, sizeof(int), 1, f);
+
+        for (int k = 0; k < adjCount; k++) {
+            int x_adj, y_adj;
+            fread(&x_adj, sizeof(int), 1, f);
+            fread(&y_adj, sizeof(int), 1, f);
+
+            // Encontrar o vértice adjacente pela coordenada (as arestas ligam sempre a mesma frequência)
+            if (findVertex(g, x_adj, y_adj, frequencies[i]) == NULL) {
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    free(frequencies);
+    long bytesRead = ftell(f);
+    if (bytesRead > 0) instrumentCount(INSTRUMENT_BYTES_READ, (unsigned long long)bytesRead);
+    fclose(f);
+    if (!valid) {
+        freeGraph(g);
+        return NULL;
+    }
+    return g;
+}
+
+
+/**
+ * @brief Cria um contexto de pesquisa vazio
+ * 
+ * O contexto guarda fora do grafo o estado de uma pesquisa (vértices visitados e pilha),
+ * pelo que várias pesquisas podem correr ao mesmo tempo sobre o mesmo grafo, cada uma
+ * com o seu contexto. A memória do contexto é reutilizada entre pesquisas.
+ * 
+ * @return TraversalContext* Pointer para o contexto criado, ou NULL se faltar memória
+ */
+TraversalContext *createTraversalContext(){
+    TraversalContext *ctx = (TraversalContext*)calloc(1, sizeof(TraversalContext));
+    if (ctx != NULL) instrumentAllocation(sizeof(TraversalContext));
+    return ctx;
+}
+
+/**
+ * @brief Liberta a memória de um contexto de pesquisa
+ * 
+ * @param ctx Pointer para o contexto
+ */
+void freeTraversalContext(TraversalContext *ctx){
+    if (ctx == NULL) return;
+    free(ctx->marks);
+    free(ctx->frames);
+    free(ctx->path);
+    free(ctx->queue);
+    free(ctx->parents);
+    free(ctx->costs);
+    free(ctx->discovered);
+    free(ctx->heap);
+    free(ctx);
+}
+
+/**
+ * @brief Prepara o contexto para uma nova pesquisa sobre o grafo
+ * 
+ * Em vez de limpar o estado visited de todos os vértices, avança a época do contexto:
+ * um vértice está visitado nesta pesquisa apenas se a sua marca for igual à época atual.
+ * 
+ * @param ctx Pointer para o contexto
+ * @param g Pointer para o grafo a pesquisar
+ * @return true se o contexto está pronto, false se faltou memória
+ */
+static bool beginTraversal(TraversalContext *ctx, Graph *g){
+    int needed = g->idLimit;
+    if (needed > ctx->markCapacity) {
+        int newCapacity = ctx->markCapacity > 0 ? ctx->markCapacity : 64;
+        while (newCapacity < needed) newCapacity *= 2;
+        unsigned int *marks = (unsigned int*)realloc(ctx->marks, sizeof(unsigned int) * newCapacity);
+        if (marks == NULL) return false;
+        instrumentAllocation(sizeof(unsigned int) * newCapacity);
+        memset(marks + ctx->markCapacity, 0, sizeof(unsigned int) * (newCapacity - ctx->markCapacity));
+        ctx->marks = marks;
+        ctx->markCapacity = newCapacity;
+    }
+
+    ctx->epoch++;
+    // Quando a época dá a volta, as marcas antigas têm de ser limpas uma vez
+    if (ctx->epoch == 0) {
+        memset(ctx->marks, 0, sizeof(unsigned int) * ctx->markCapacity);
+        ctx->epoch = 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Garante espaço para mais uma entrada na pilha do contexto
+ * 
+ * A capacidade cresce até caber count + 1 entradas de uma vez, para quem escreve um
+ * caminho inteiro (routeFromParents) depois de uma única reserva.
+ * 
+ * @param ctx Pointer para o contexto
+ * @param count Número de entradas já ocupadas
+ * @return true se há espaço, false se faltou memória
+ */
+static bool reserveFrame(TraversalContext *ctx, int count){
+    if (count < ctx->frameCapacity) return true;
+
+    int newCapacity = ctx->frameCapacity > 0 ? ctx->frameCapacity * 2 : 64;
+    while (newCapacity <= count) newCapacity *= 2;
+    TraversalFrame *frames = (TraversalFrame*)realloc(ctx->frames, sizeof(TraversalFrame) * newCapacity);
+    if (frames == NULL) return false;
+    ctx->frames = frames;
+    // Se o path não crescer, frameCapacity fica com a capacidade antiga, que cabe nos dois arrays
+    Vertex **path = (Vertex**)realloc(ctx->path, sizeof(Vertex*) * newCapacity);
+    if (path == NULL) return false;
+    ctx->path = path;
+    instrumentAllocation(sizeof(TraversalFrame) * newCapacity);
+    instrumentAllocation(sizeof(Vertex*) * newCapacity);
+    ctx->frameCapacity = newCapacity;
+    return true;
+}
+
+/**
+ * @brief Coloca um vértice no fim da fila circular do contexto
+ * 
+ * Quando a fila está cheia, a capacidade duplica e os vértices são copiados pela ordem
+ * da fila para o início do novo array. A memória fica no contexto para as pesquisas seguintes.
+ * 
+ * @param ctx Pointer para o contexto
+ * @param v Vértice a colocar na fila
+ * @return true se o vértice entrou na fila, false se faltou memória
+ */
+static bool enqueueVertex(TraversalContext *ctx, Vertex *v){
+    if (ctx->queueCount == ctx->queueCapacity) {
+        int newCapacity = ctx->queueCapacity > 0 ? ctx->queueCapacity * 2 : 64;
+        Vertex **queue = (Vertex**)malloc(sizeof(Vertex*) * newCapacity);
+        if (queue == NULL) return false;
+        instrumentAllocation(sizeof(Vertex*) * newCapacity);
+
+        for (int i = 0; i < ctx->queueCount; i++) {
+            queue[i] = ctx->queue[(ctx->queueHead + i) & (ctx->queueCapacity - 1)];
+        }
+        free(ctx->queue);
+        ctx->queue = queue;
+        ctx->queueCapacity = newCapacity;
+        ctx->queueHead = 0;
+    }
+    ctx->queue[(ctx->queueHead + ctx->queueCount) & (ctx->queueCapacity - 1)] = v;
+    ctx->queueCount++;
+    return true;
+}
+
+/**
+ * @brief Retira o primeiro vértice da fila circular do contexto
+ * 
+ * @param ctx Pointer para o contexto
+ * @return Vertex* Primeiro vértice da fila, ou NULL se estiver vazia
+ */
+static Vertex *dequeueVertex(TraversalContext *ctx){
+    if (ctx->queueCount == 0) return NULL;
+    Vertex *v = ctx->queue[ctx->queueHead];
+    ctx->queueHead = (ctx->queueHead + 1) & (ctx->queueCapacity - 1);
+    ctx->queueCount--;
+    return v;
+}
+
+/** @brief Indica se o vértice já foi visitado na pesquisa atual do contexto */
+static inline bool isVisited(TraversalContext *ctx, Vertex *v){
+    return ctx->marks[v->id] == ctx->epoch;
+}
+
+/** @brief Marca o vértice como visitado na pesquisa atual do contexto */
+static inline void markVisited(TraversalContext *ctx, Vertex *v){
+    ctx->marks[v->id] = ctx->epoch;
+}
+
+/** @brief Desmarca o vértice na pesquisa atual do contexto */
+static inline void unmarkVisited(TraversalContext *ctx, Vertex *v){
+    ctx->marks[v->id] = ctx->epoch - 1;
+}
+
+/**
+ * @brief Visita em profundidade a partir de um vértice, entregando cada vértice visitado
+ * 
+ * Versão iterativa da visita em profundidade: cada entrada da pilha do contexto guarda
+ * o vértice e o cursor dos seus adjacentes, o que reproduz a ordem da visita recursiva
+ * (visita sempre o primeiro adjacente de cada vértice) sem esgotar a stack em grafos profundos.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param start Vértice inicial
+ * @param visit Função chamada para cada vértice visitado
+ * @param userData Pointer passado sem alterações ao visit
+ * @return true se a pesquisa terminou, false se faltou memória
+ */
+static bool dfsFrom(Graph* g, TraversalContext *ctx, Vertex* start, VertexVisitor visit, void *userData) {
+    if (!beginTraversal(ctx, g) || !reserveFrame(ctx, 0)) {
+        return false;
+    }
+
+    int top = 0;
+    markVisited(ctx, start);
+    visit(start, userData);
+    ctx->frames[top].vertex = start;
+    beginNeighbors(g, start, &ctx->frames[top].cursor);
+    top++;
+
+    while (top > 0) {
+        TraversalFrame *frame = &ctx->frames[top - 1];
+        Vertex* v = frame->vertex;
+
+        // Avança até ao próximo adjacente ainda não visitado com a mesma frequência
+        Vertex* neighbor;
+        while ((neighbor = nextNeighbor(g, v, &frame->cursor)) != NULL) {
+            if (!isVisited(ctx, neighbor) && neighbor->frequency == v->frequency) break;
+        }
+
+        if (neighbor == NULL) {
+            top--;
+            continue;
+        }
+        if (!reserveFrame(ctx, top)) return false;
+
+        markVisited(ctx, neighbor);
+        visit(neighbor, userData);
+        ctx->frames[top].vertex = neighbor;
+        beginNeighbors(g, neighbor, &ctx->frames[top].cursor);
+        top++;
+    }
+    return true;
+}
+
+/**
+ * @brief Visita em largura a partir de um vértice, entregando cada vértice visitado
+ * 
+ * Usa uma estrutura em fila para visitar todos os vértices alcançáveis ligados a partir
+ * do vértice inicial, com a mesma frequência. Os visitados e a fila circular ficam no
+ * contexto, que a aumenta quando fica cheia e a reutiliza nas pesquisas seguintes.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param start Vértice inicial
+ * @param visit Função chamada para cada vértice visitado
+ * @param userData Pointer passado sem alterações ao visit
+ * @return true se a pesquisa terminou, false se faltou memória
+ */
+static bool bfsFrom(Graph* g, TraversalContext *ctx, Vertex* start, VertexVisitor visit, void *userData) {
+    if (!beginTraversal(ctx, g)) {
+        return false;
+    }
+
+    // Fila circular do contexto, esvaziada de pesquisas anteriores
+    ctx->queueHead = 0;
+    ctx->queueCount = 0;
+
+    // Iniciar com o vértice inicial
+    if (!enqueueVertex(ctx, start)) return false;
+    markVisited(ctx, start);
+
+    Vertex* current;
+    while ((current = dequeueVertex(ctx)) != NULL) {
+        visit(current, userData);
+
+        NeighborCursor c;
+        beginNeighbors(g, current, &c);
+        Vertex* neighbor;
+        while ((neighbor = nextNeighbor(g, current, &c)) != NULL) {
+            if (!isVisited(ctx, neighbor) && neighbor->frequency == current->frequency) {
+                //enqueue
+                if (!enqueueVertex(ctx, neighbor)) return false;
+                markVisited(ctx, neighbor);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Procura os caminhos entre dois vértices, entregando cada caminho encontrado
+ * 
+ * Versão iterativa da procura recursiva: a pilha do contexto é o caminho atual e cada
+ * entrada guarda o cursor dos adjacentes ainda por explorar. Ao recuar, o vértice é
+ * desmarcado para poder fazer parte de outros caminhos.
+ * 
+ * Os caminhos com mais de maxLength vértices não são explorados, e a procura termina
+ * depois de maxResults caminhos ou quando o visit devolve false.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param origin Vértice de origem
+ * @param destination Vértice de destino
+ * @param maxLength Número máximo de vértices de cada caminho, ou 0 para não limitar
+ * @param maxResults Número máximo de caminhos a entregar, ou 0 para não limitar
+ * @param visit Função chamada para cada caminho encontrado
+ * @param userData Pointer passado sem alterações ao visit
+ * @return int Número de caminhos entregues, ou -1 se faltou memória
+ */
+static int pathsBetween(Graph* g, TraversalContext *ctx, Vertex* origin, Vertex* destination,
+                        int maxLength, int maxResults, PathVisitor visit, void *userData) {
+    if (!beginTraversal(ctx, g) || !reserveFrame(ctx, 0)) {
+        return -1;
+    }
+
+    int found = 0;
+    int length = 0;
+    markVisited(ctx, origin);
+    ctx->frames[length].vertex = origin;
+    ctx->path[length] = origin;
+    beginNeighbors(g, origin, &ctx->frames[length].cursor);
+    length++;
+
+    while (length > 0) {
+        TraversalFrame *frame = &ctx->frames[length - 1];
+        Vertex* current = frame->vertex;
+
+        // Se chegou ao destino entrega o caminho e recua
+        if (current == destination) {
+            found++;
+            if (!visit(ctx->path, length, userData) || found == maxResults) break;
+            unmarkVisited(ctx, current);
+            length--;
+            continue;
+        }
+
+        // Só continua por adjacentes ainda fora do caminho e com a mesma frequência que o atual
+        Vertex* neighbor = NULL;
+        if (maxLength <= 0 || length < maxLength) {
+            while ((neighbor = nextNeighbor(g, current, &frame->cursor)) != NULL) {
+                if (!isVisited(ctx, neighbor) && neighbor->frequency == current->frequency) break;
+            }
+        }
+
+        if (neighbor == NULL) {
+            unmarkVisited(ctx, current);
+            length--;
+            continue;
+        }
+        if (!reserveFrame(ctx, length)) return -1;
+
+        markVisited(ctx, neighbor);
+        ctx->frames[length].vertex = neighbor;
+        ctx->path[length] = neighbor;
+        beginNeighbors(g, neighbor, &ctx->frames[length].cursor);
+        length++;
+    }
+    return found;
+}
+
+/**
+ * @brief Depth-First Search (DFS) que entrega cada vértice visitado a um visitor
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ * @param visit Função chamada para cada vértice, pela ordem da visita em profundidade
+ * @param userData Pointer passado sem alterações ao visit
+ * @return true se a pesquisa foi feita, false se o vértice não existe ou faltou memória
+ */
+bool depthFirstSearchVisit(Graph* g, TraversalContext *ctx, int startX, int startY, char frequency,
+                           VertexVisitor visit, void *userData) {
+    INSTRUMENT_FUNCTION();
+    // Encontrar o vértice inicial
+    Vertex* start = findVertex(g, startX, startY, frequency);
+    if (start == NULL || visit == NULL || ctx == NULL) {
+        return false;
+    }
+    return dfsFrom(g, ctx, start, visit, userData);
+}
+
+/**
+ * @brief Depth-First Search (DFS) usando um contexto de pesquisa
+ * 
+ * Procura o vértice inicial com as coordenadas e frequência dadas
+ * e imprime os vértices pela ordem da visita em profundidade.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ */
+void depthFirstSearchWithContext(Graph* g, TraversalContext *ctx, int startX, int startY, char frequency) {
+    INSTRUMENT_FUNCTION();
+    OutputWriter *w = createOutputWriter(stdout, OUTPUT_TEXT);
+    if (w == NULL) return;
+    writeDepthFirstSearch(w, g, ctx, startX, startY, frequency);
+    freeOutputWriter(w);
+}
+
+/**
+ * @brief Função principal que inicia a Depth-First Search (DFS) no grafo
+ * 
+ * Procura o vértice inicial com as coordenadas e frequência dadas
+ * e faz a visita em profundidade com um contexto de pesquisa temporário.
+ * 
+ * @param g Pointer para o grafo
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param freq Frequência do vértice inicial
+ */
+void depthFirstSearch(Graph* g, int startX, int startY, char frequency) {
+    INSTRUMENT_FUNCTION();
+    TraversalContext *ctx = createTraversalContext();
+    if (ctx == NULL) return;
+    depthFirstSearchWithContext(g, ctx, startX, startY, frequency);
+    freeTraversalContext(ctx);
+}
+
+/**
+ * @brief Breadth-First Search (BFS) que entrega cada vértice visitado a um visitor
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ * @param visit Função chamada para cada vértice, pela ordem da visita em largura
+ * @param userData Pointer passado sem alterações ao visit
+ * @return true se a pesquisa foi feita, false se o vértice não existe ou faltou memória
+ */
+bool breadthFirstSearchVisit(Graph* g, TraversalContext *ctx, int startX, int startY, char frequency,
+                             VertexVisitor visit, void *userData) {
+    INSTRUMENT_FUNCTION();
+    // Encontrar o vértice inicial
+    Vertex* start = findVertex(g, startX, startY, frequency);
+    if (start == NULL || visit == NULL || ctx == NULL) {
+        return false;
+    }
+    return bfsFrom(g, ctx, start, visit, userData);
+}
+
+/**
+ * @brief Breadth-First Search (BFS) usando um contexto de pesquisa
+ * 
+ * Procura o vértice inicial com as coordenadas e frequência dadas
+ * e imprime os vértices pela ordem da visita em largura.
+ * 
+ * BFS em output: visita todos os adjacentes diretos primeiro
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ */
+void breadthFirstSearchWithContext(Graph* g, TraversalContext *ctx, int startX, int startY, char frequency) {
+    INSTRUMENT_FUNCTION();
+    OutputWriter *w = createOutputWriter(stdout, OUTPUT_TEXT);
+    if (w == NULL) return;
+    writeBreadthFirstSearch(w, g, ctx, startX, startY, frequency);
+    freeOutputWriter(w);
+}
+
+/**
+ * @brief Implementa a Breadth-First Search (BFS) no grafo
+ * 
+ * Procura o vértice inicial com as coordenadas e frequência dadas e faz a visita
+ * em largura com um contexto de pesquisa temporário.
+ * 
+ * @param g Pointer para o grafo
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param freq Frequência do vértice inicial
+ */
+void breadthFirstSearch(Graph* g, int startX, int startY, char frequency) {
+    INSTRUMENT_FUNCTION();
+    TraversalContext *ctx = createTraversalContext();
+    if (ctx == NULL) return;
+    breadthFirstSearchWithContext(g, ctx, startX, startY, frequency);
+    freeTraversalContext(ctx);
+}
+
+/**
+ * @brief Encontra e imprime todos os caminhos entre dois vértices usando um contexto de pesquisa
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param x1 Coordenada X do vértice de origem
+ * @param y1 Coordenada Y do vértice de origem
+ * @param x2 Coordenada X do vértice de destino
+ * @param y2 Coordenada Y do vértice de destino
+ * @param frequency Frequência comum requerida para os vértices do caminho
+ */
+void findAllPathsWithContext(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char frequency) {
+    INSTRUMENT_FUNCTION();
+    OutputWriter *w = createOutputWriter(stdout, OUTPUT_TEXT);
+    if (w == NULL) return;
+    writePaths(w, g, ctx, x1, y1, x2, y2, frequency, 0, 0);
+    freeOutputWriter(w);
+}
+
+/**
+ * @brief Encontra e imprime todos os caminhos entre dois vértices com frequência comum.
+ *
+ * Procura os vértices de origem e destino no grafo com as coordenadas e frequência indicadas.
+ * Se ambos forem encontrados, inicia a pesquisa para listar todos os caminhos possíveis entre eles,
+ * com um contexto de pesquisa temporário.
+ *
+ * @param g Pointer para o grafo
+ * @param x1 Coordenada X do vértice de origem
+ * @param y1 Coordenada Y do vértice de origem
+ * @param x2 Coordenada X do vértice de destino
+ * @param y2 Coordenada Y do vértice de destino
+ * @param frequency Frequência comum requerida para os vértices do caminho
+ */
+void findAllPaths(Graph* g, int x1, int y1, int x2, int y2, char frequency) {
+    INSTRUMENT_FUNCTION();
+    TraversalContext *ctx = createTraversalContext();
+    if (ctx == NULL) return;
+    findAllPathsWithContext(g, ctx, x1, y1, x2, y2, frequency);
+    freeTraversalContext(ctx);
+}
+
+/**
+ * @brief Acrescenta um vértice ao resultado de uma consulta
+ * 
+ * @param r Pointer para o resultado
+ * @param v Vértice a acrescentar
+ */
+static void resultAddVertex(QueryResult *r, Vertex *v){
+    if (r->failed) return;
+    if (r->vertexCount == r->vertexCapacity) {
+        int newCapacity = r->vertexCapacity > 0 ? r->vertexCapacity * 2 : 16;
+        Vertex **vertices = (Vertex**)realloc(r->vertices, sizeof(Vertex*) * newCapacity);
+        if (vertices == NULL) {
+            r->failed = true;
+            return;
+        }
+        r->vertices = vertices;
+        r->vertexCapacity = newCapacity;
+    }
+    r->vertices[r->vertexCount++] = v;
+}
+
+/** @brief Guarda no resultado (QueryResult) um vértice visitado pelo DFS ou BFS */
+static void collectVisited(Vertex *v, void *userData){
+    resultAddVertex((QueryResult*)userData, v);
+}
+
+/**
+ * @brief Procura caminhos entre dois vértices com limites, entregando-os um a um
+ * 
+ * Ao contrário do findAllPaths, os caminhos não são impressos: cada caminho é entregue
+ * ao callback assim que é encontrado e a procura pode ser limitada no comprimento dos
+ * caminhos e no número de resultados, ou terminada pelo callback (devolvendo false).
+ * O array path só é válido durante a chamada ao callback.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param x1 Coordenada X do vértice de origem
+ * @param y1 Coordenada Y do vértice de origem
+ * @param x2 Coordenada X do vértice de destino
+ * @param y2 Coordenada Y do vértice de destino
+ * @param frequency Frequência comum requerida para os vértices do caminho
+ * @param maxLength Número máximo de vértices de cada caminho, ou 0 para não limitar
+ * @param maxResults Número máximo de caminhos, ou 0 para não limitar
+ * @param visit Função chamada para cada caminho; devolve false para terminar a procura
+ * @param userData Pointer passado sem alterações ao visit
+ * @return int Número de caminhos entregues, ou -1 se um dos vértices não existir ou faltar memória
+ */
+int findPathsBounded(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char frequency,
+                     int maxLength, int maxResults, PathVisitor visit, void *userData) {
+    INSTRUMENT_FUNCTION();
+    Vertex* origin = findVertex(g, x1, y1, frequency);
+    Vertex* destination = findVertex(g, x2, y2, frequency);
+    if (!origin || !destination || visit == NULL || ctx == NULL) {
+        return -1;
+    }
+    return pathsBetween(g, ctx, origin, destination, maxLength, maxResults, visit, userData);
+}
+
+/**
+ * @brief Prepara o contexto para uma procura de caminho mais curto
+ * 
+ * Reserva os arrays indexados por id e avança a época duas vezes: a época anterior
+ * (epoch - 1) e a atual (epoch) servem de duas marcas distintas, uma para cada ponta da
+ * pesquisa bidirecional, ou para vértices abertos e fechados no A*.
+ * 
+ * @param ctx Pointer para o contexto
+ * @param g Pointer para o grafo a pesquisar
+ * @return true se o contexto está pronto, false se faltou memória
+ */
+static bool beginRoute(TraversalContext *ctx, Graph *g){
+    int needed = g->idLimit;
+    if (needed > ctx->routeCapacity) {
+        int newCapacity = ctx->routeCapacity > 0 ? ctx->routeCapacity : 64;
+        while (newCapacity < needed) newCapacity *= 2;
+        Vertex **parents = (Vertex**)realloc(ctx->parents, sizeof(Vertex*) * newCapacity);
+        if (parents == NULL) return false;
+        ctx->parents = parents;
+        double *costs = (double*)realloc(ctx->costs, sizeof(double) * newCapacity);
+        if (costs == NULL) return false;
+        ctx->costs = costs;
+        Vertex **discovered = (Vertex**)realloc(ctx->discovered, sizeof(Vertex*) * 2 * newCapacity);
+        if (discovered == NULL) return false;
+        ctx->discovered = discovered;
+        instrumentAllocation((sizeof(Vertex*) * 3 + sizeof(double)) * newCapacity);
+        ctx->routeCapacity = newCapacity;
+    }
+    if (!beginTraversal(ctx, g)) return false;
+    // As duas épocas são reservadas juntas: se a segunda desse a volta, a primeira ficava
+    // com o valor 0 das marcas limpas e todos os vértices pareciam já alcançados
+    if (ctx->epoch == UINT_MAX) {
+        memset(ctx->marks, 0, sizeof(unsigned int) * ctx->markCapacity);
+        ctx->epoch = 1;
+    }
+    ctx->epoch++;
+    return true;
+}
+
+/**
+ * @brief Copia para ctx->path o caminho de start até v, seguindo os predecessores
+ * 
+ * @param ctx Pointer para o contexto
+ * @param v Último vértice do caminho
+ * @param offset Posição de ctx->path onde o caminho começa
+ * @param reverse true para escrever o caminho de v até start
+ * @return int Número de vértices do caminho, ou -1 se faltou memória
+ */
+static int routeFromParents(TraversalContext *ctx, Vertex *v, int offset, bool reverse){
+    int length = 0;
+    for (Vertex *p = v; p != NULL; p = ctx->parents[p->id]) length++;
+    if (!reserveFrame(ctx, offset + length)) return -1;
+    int i = reverse ? offset : offset + length - 1;
+    for (Vertex *p = v; p != NULL; p = ctx->parents[p->id]) {
+        ctx->path[i] = p;
+        i += reverse ? 1 : -1;
+    }
+    return length;
+}
+
+/**
+ * @brief Caminho com menos ligações entre dois vértices, por BFS bidirecional
+ * 
+ * As duas pontas avançam um nível de cada vez, sempre a que tem a fronteira mais pequena,
+ * até um vértice de uma ponta encontrar um adjacente da outra. Como o nível é tratado
+ * por inteiro, o primeiro encontro dá um caminho mínimo. O caminho fica em ctx->path.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param start Vértice de origem
+ * @param target Vértice de destino (da mesma componente que start)
+ * @return int Número de vértices do caminho, 0 se não há caminho, -1 se faltou memória
+ */
+static int bidirectionalRoute(Graph *g, TraversalContext *ctx, Vertex *start, Vertex *target){
+    if (!beginRoute(ctx, g)) return -1;
+    // Lado 0 parte da origem, lado 1 do destino; cada lado descobre no máximo idLimit vértices
+    unsigned int mark[2] = { ctx->epoch - 1, ctx->epoch };
+    Vertex **found[2] = { ctx->discovered, ctx->discovered + ctx->routeCapacity };
+    int levelStart[2] = { 0, 0 };
+    int levelEnd[2] = { 1, 1 };
+    found[0][0] = start;
+    found[1][0] = target;
+    ctx->marks[start->id] = mark[0];
+    ctx->marks[target->id] = mark[1];
+    ctx->parents[start->id] = NULL;
+    ctx->parents[target->id] = NULL;
+
+    while (levelStart[0] < levelEnd[0] && levelStart[1] < levelEnd[1]) {
+        int side = levelEnd[0] - levelStart[0] <= levelEnd[1] - levelStart[1] ? 0 : 1;
+        int other = 1 - side;
+        int end = levelEnd[side];
+        for (int i = levelStart[side]; i < levelEnd[side]; i++) {
+            Vertex *v = found[side][i];
+            NeighborCursor c;
+            beginNeighbors(g, v, &c);
+            Vertex *u;
+            while ((u = nextNeighbor(g, v, &c)) != NULL) {
+                if (u->frequency != v->frequency || ctx->marks[u->id] == mark[side]) continue;
+                if (ctx->marks[u->id] == mark[other]) {
+                    // Encontro: origem ... v/u ... destino
+                    Vertex *nearStart = side == 0 ? v : u;
+                    Vertex *nearTarget = side == 0 ? u : v;
+                    int first = routeFromParents(ctx, nearStart, 0, false);
+                    if (first < 0) return -1;
+                    int second = routeFromParents(ctx, nearTarget, first, true);
+                    return second < 0 ? -1 : first + second;
+                }
+                ctx->marks[u->id] = mark[side];
+                ctx->parents[u->id] = v;
+                found[side][end++] = u;
+            }
+        }
+        levelStart[side] = levelEnd[side];
+        levelEnd[side] = end;
+    }
+    return 0;
+}
+
+/** @brief Distância euclidiana entre duas antenas */
+static double antennaDistance(const Vertex *a, const Vertex *b){
+    double dx = (double)a->x - b->x;
+    double dy = (double)a->y - b->y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * @brief Coloca uma entrada na fila de prioridade do A*
+ * 
+ * @param ctx Pointer para o contexto
+ * @param entry Entrada a colocar
+ * @return true se a entrada entrou na fila, false se faltou memória
+ */
+static bool routePush(TraversalContext *ctx, RouteEntry entry){
+    if (ctx->heapCount == ctx->heapCapacity) {
+        int newCapacity = ctx->heapCapacity > 0 ? ctx->heapCapacity * 2 : 64;
+        RouteEntry *heap = (RouteEntry*)realloc(ctx->heap, sizeof(RouteEntry) * newCapacity);
+        if (heap == NULL) return false;
+        instrumentAllocation(sizeof(RouteEntry) * newCapacity);
+        ctx->heap = heap;
+        ctx->heapCapacity = newCapacity;
+    }
+    int i = ctx->heapCount++;
+    while (i > 0 && ctx->heap[(i - 1) / 2].priority > entry.priority) {
+        ctx->heap[i] = ctx->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    ctx->heap[i] = entry;
+    return true;
+}
+
+/**
+ * @brief Retira a entrada de menor prioridade da fila do A*
+ * 
+ * @param ctx Pointer para o contexto (com a fila não vazia)
+ * @return RouteEntry Entrada retirada
+ */
+static RouteEntry routePop(TraversalContext *ctx){
+    RouteEntry top = ctx->heap[0];
+    RouteEntry last = ctx->heap[--ctx->heapCount];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= ctx->heapCount) break;
+        if (child + 1 < ctx->heapCount && ctx->heap[child + 1].priority < ctx->heap[child].priority) child++;
+        if (ctx->heap[child].priority >= last.priority) break;
+        ctx->heap[i] = ctx->heap[child];
+        i = child;
+    }
+    if (ctx->heapCount > 0) ctx->heap[i] = last;
+    return top;
+}
+
+/**
+ * @brief Caminho de menor distância total entre dois vértices, por A*
+ * 
+ * Cada ligação custa a distância euclidiana entre as antenas e a estimativa é a distância
+ * euclidiana até ao destino, que nunca excede o custo real; por isso um vértice fechado
+ * já tem o custo mínimo e não volta a ser aberto. O caminho fica em ctx->path.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param start Vértice de origem
+ * @param target Vértice de destino (da mesma componente que start)
+ * @param cost Recebe a distância total do caminho
+ * @return int Número de vértices do caminho, 0 se não há caminho, -1 se faltou memória
+ */
+static int weightedRoute(Graph *g, TraversalContext *ctx, Vertex *start, Vertex *target, double *cost){
+    if (!beginRoute(ctx, g)) return -1;
+    // Abertos têm a marca epoch - 1 (custo conhecido), fechados a marca epoch
+    unsigned int open = ctx->epoch - 1;
+    unsigned int closed = ctx->epoch;
+    ctx->heapCount = 0;
+    ctx->marks[start->id] = open;
+    ctx->parents[start->id] = NULL;
+    ctx->costs[start->id] = 0;
+    RouteEntry first = { antennaDistance(start, target), 0, start };
+    if (!routePush(ctx, first)) return -1;
+
+    while (ctx->heapCount > 0) {
+        RouteEntry e = routePop(ctx);
+        Vertex *v = e.vertex;
+        // Entradas antigas de vértices que entretanto ficaram mais baratos
+        if (ctx->marks[v->id] == closed || e.cost > ctx->costs[v->id]) continue;
+        ctx->marks[v->id] = closed;
+        if (v == target) {
+            *cost = ctx->costs[v->id];
+            return routeFromParents(ctx, target, 0, false);
+        }
+
+        NeighborCursor c;
+        beginNeighbors(g, v, &c);
+        Vertex *u;
+        while ((u = nextNeighbor(g, v, &c)) != NULL) {
+            if (u->frequency != v->frequency || ctx->marks[u->id] == closed) continue;
+            double through = ctx->costs[v->id] + antennaDistance(v, u);
+            if (ctx->marks[u->id] == open && through >= ctx->costs[u->id]) continue;
+            ctx->marks[u->id] = open;
+            ctx->costs[u->id] = through;
+            ctx->parents[u->id] = v;
+            RouteEntry next = { through + antennaDistance(u, target), through, u };
+            if (!routePush(ctx, next)) return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Procura o caminho mais curto entre duas antenas, pelo método indicado
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param start Vértice de origem
+ * @param target Vértice de destino
+ * @param weighted true para o A* (distância euclidiana), false para o BFS bidirecional
+ * @param cost Recebe o custo do caminho (ligações ou distância)
+ * @return int Número de vértices do caminho (em ctx->path), 0 se não há caminho,
+ *         -1 se faltou memória
+ */
+static int routeBetween(Graph *g, TraversalContext *ctx, Vertex *start, Vertex *target, bool weighted,
+                        double *cost){
+    *cost = 0;
+    if (start == target) {
+        if (!reserveFrame(ctx, 1)) return -1;
+        ctx->path[0] = start;
+        return 1;
+    }
+    // As componentes respondem logo quando não há caminho
+    if (!sameComponent(g, start, target)) return 0;
+    if (weighted) return weightedRoute(g, ctx, start, target, cost);
+    int length = bidirectionalRoute(g, ctx, start, target);
+    if (length > 0) *cost = length - 1;
+    return length;
+}
+
+/**
+ * @brief Caminho com menos ligações entre duas antenas da mesma frequência
+ * 
+ * Usa um BFS bidirecional a partir das duas antenas. Se o caminho couber no buffer é
+ * copiado para path (path[0] é a origem); caso contrário só o comprimento é devolvido,
+ * para o buffer ser aumentado.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param x1 Coordenada x da origem
+ * @param y1 Coordenada y da origem
+ * @param x2 Coordenada x do destino
+ * @param y2 Coordenada y do destino
+ * @param frequency Frequência das antenas
+ * @param path Buffer que recebe os vértices do caminho (pode ser NULL se capacity for 0)
+ * @param capacity Número de posições do buffer
+ * @return int Número de vértices do caminho, 0 se não há caminho, -1 se uma das antenas
+ *         não existe ou faltou memória
+ */
+int shortestPath(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char frequency,
+                 Vertex **path, int capacity){
+    INSTRUMENT_FUNCTION();
+    Vertex *start = findVertex(g, x1, y1, frequency);
+    Vertex *target = findVertex(g, x2, y2, frequency);
+    if (start == NULL || target == NULL || ctx == NULL) return -1;
+    double cost;
+    int length = routeBetween(g, ctx, start, target, false, &cost);
+    if (length > 0 && length <= capacity) memcpy(path, ctx->path, sizeof(Vertex*) * length);
+    return length;
+}
+
+/**
+ * @brief Caminho de menor distância total entre duas antenas da mesma frequência
+ * 
+ * Variante com pesos do shortestPath: cada ligação custa a distância euclidiana entre as
+ * antenas e a procura é um A* guiado pela distância euclidiana até ao destino.
+ * 
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param x1 Coordenada x da origem
+ * @param y1 Coordenada y da origem
+ * @param x2 Coordenada x do destino
+ * @param y2 Coordenada y do destino
+ * @param frequency Frequência das antenas
+ * @param path Buffer que recebe os vértices do caminho (pode ser NULL se capacity for 0)
+ * @param capacity Número de posições do buffer
+ * @param cost Recebe a distância total do caminho (pode ser NULL)
+ * @return int Número de vértices do caminho, 0 se não há caminho, -1 se uma das antenas
+ *         não existe ou faltou memória
+ */
+int shortestPathWeighted(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char frequency,
+                         Vertex **path, int capacity, double *cost){
+    INSTRUMENT_FUNCTION();
+    Vertex *start = findVertex(g, x1, y1, frequency);
+    Vertex *target = findVertex(g, x2, y2, frequency);
+    if (start == NULL || target == NULL || ctx == NULL) return -1;
+    double total;
+    int length = routeBetween(g, ctx, start, target, true, &total);
+    if (cost != NULL) *cost = total;
+    if (length > 0 && length <= capacity) memcpy(path, ctx->path, sizeof(Vertex*) * length);
+    return length;
+}
+
+/**
+ * @brief Multiplica dois contadores sem ultrapassar o máximo de um unsigned long long
+ */
+static unsigned long long saturatingMultiply(unsigned long long a, unsigned long long b) {
+    if (a != 0 && b > ULLONG_MAX / a) return ULLONG_MAX;
+    return a * b;
+}
+
+/**
+ * @brief Soma dois contadores sem ultrapassar o máximo de um unsigned long long
+ */
+static unsigned long long saturatingAdd(unsigned long long a, unsigned long long b) {
+    return a > ULLONG_MAX - b ? ULLONG_MAX : a + b;
+}
+
+/**
+ * @struct PathCountState
+ * @brief Estado da contagem de caminhos com memorização numa componente pequena.
+ * 
+ * Os vértices da componente são numerados de 0 a k - 1 (k <= 64), pelo que o conjunto
+ * de vértices já usados por um caminho cabe numa máscara de 64 bits.
+ */
+typedef struct PathCountState{
+    unsigned long long adjacency[64]; // Adjacentes (da mesma frequência) de cada vértice local
+    int target; // Índice local do destino
+    int maxLength; // Número máximo de vértices do caminho, ou 0 para não limitar
+    unsigned long long *memoKeys; // Máscara de cada entrada (0 = vazia)
+    int *memoVertices; // Vértice de cada entrada
+    unsigned long long *memoValues; // Número de caminhos de cada entrada
+    int memoCapacity; // Potência de 2
+    int memoCount;
+    bool overflow; // true se a tabela de memorização ficou cheia
+} PathCountState;
+
+/**
+ * @brief Conta os caminhos simples de v até ao destino que evitam os vértices de used
+ * 
+ * O resultado só depende de (v, used), porque o comprimento do caminho até v é o número
+ * de bits de used; por isso cada estado é calculado uma única vez.
+ * 
+ * @param s Estado da contagem
+ * @param v Índice local do vértice atual (já incluído em used)
+ * @param used Vértices já usados pelo caminho
+ * @return unsigned long long Número de caminhos (saturado no máximo)
+ */
+static unsigned long long countPathsFrom(PathCountState *s, int v, unsigned long long used) {
+    if (v == s->target) return 1;
+    if (s->maxLength > 0 && __builtin_popcountll(used) >= s->maxLength) return 0;
+
+    unsigned int mask = (unsigned int)s->memoCapacity - 1;
+    unsigned int slot = (unsigned int)((used * 0x9E3779B97F4A7C15ULL) >> 32 ^ (unsigned int)v * 0x85EBCA77u) & mask;
+    while (s->memoKeys[slot] != 0) {
+        if (s->memoKeys[slot] == used && s->memoVertices[slot] == v) return s->memoValues[slot];
+        slot = (slot + 1) & mask;
+    }
+
+    unsigned long long total = 0;
+    unsigned long long candidates = s->adjacency[v] & ~used;
+    while (candidates != 0 && !s->overflow) {
+        int u = __builtin_ctzll(candidates);
+        candidates &= candidates - 1;
+        total = saturatingAdd(total, countPathsFrom(s, u, used | (1ULL << u)));
+    }
+
+    // Guarda o resultado enquanto a tabela tiver menos de metade ocupada
+    if (s->memoCount * 2 >= s->memoCapacity) {
+        s->overflow = true;
+        return total;
+    }
+    while (s->memoKeys[slot] != 0) slot = (slot + 1) & mask;
+    s->memoKeys[slot] = used;
+    s->memoVertices[slot] = v;
+    s->memoValues[slot] = total;
+    s->memoCount++;
+    return total;
+}
+
+/**
+ * @brief Conta os caminhos simples entre dois vértices sem os enumerar
+ * 
+ * Primeiro encontra a componente (da mesma frequência) da origem. Se a componente for
+ * completa, como as criadas pelo addVertex, o número de caminhos com j vértices intermédios
+ * é (k-2)!/(k-2-j)! e a contagem é imediata. Caso contrário, para componentes até 64 vértices,
+ * usa programação dinâmica com memorização sobre (vértice atual, vértices usados).
+ * 
+ * @param g Pointer para o grafo
+ * @param x1 Coordenada X do vértice de origem
+ * @param y1 Coordenada Y do vértice de origem
+ * @param x2 Coordenada X do vértice de destino
+ * @param y2 Coordenada Y do vértice de destino
+ * @param frequency Frequência comum requerida para os vértices do caminho
+ * @param maxLength Número máximo de vértices de cada caminho, ou 0 para não limitar
+ * @param count Onde fica o número de caminhos (ULLONG_MAX se não couber num unsigned long long)
+ * @return true se a contagem foi feita, false se um vértice não existe ou a componente é demasiado grande
+ */
+bool countPaths(Graph* g, int x1, int y1, int x2, int y2, char frequency, int maxLength, unsigned long long *count) {
+    INSTRUMENT_FUNCTION();
+    Vertex* origin = findVertex(g, x1, y1, frequency);
+    Vertex* destination = findVertex(g, x2, y2, frequency);
+    if (!origin || !destination || count == NULL) return false;
+
+    *count = 0;
+    if (origin == destination) {
+        *count = 1;
+        return true;
+    }
+
+    // Vértices da componente da origem
+    TraversalContext *ctx = createTraversalContext();
+    QueryResult component;
+    memset(&component, 0, sizeof(component));
+    if (ctx == NULL || !bfsFrom(g, ctx, origin, collectVisited, &component) || component.failed) {
+        freeTraversalContext(ctx);
+        free(component.vertices);
+        return false;
+    }
+
+    int k = component.vertexCount;
+    bool reachable = isVisited(ctx, destination);
+    bool exact = true;
+
+    // Componente completa: cada vértice tem os outros k - 1 como adjacentes
+    bool complete = g->mode == GRAPH_IMPLICIT;
+    if (reachable && !complete) {
+        complete = true;
+        for (int i = 0; i < k && complete; i++) {
+            int degree = 0;
+            NeighborCursor c;
+            beginNeighbors(g, component.vertices[i], &c);
+            Vertex *n;
+            while ((n = nextNeighbor(g, component.vertices[i], &c)) != NULL) {
+                if (n->frequency == frequency) degree++;
+            }
+            complete = degree == k - 1;
+        }
+    }
+
+    if (!reachable) {
+        *count = 0;
+    } else if (complete) {
+        // Caminhos com j intermédios: escolhas ordenadas de j dos k - 2 restantes vértices
+        int maxIntermediate = k - 2;
+        if (maxLength > 0 && maxLength - 2 < maxIntermediate) maxIntermediate = maxLength - 2;
+        unsigned long long arrangements = 1;
+        for (int j = 0; j <= maxIntermediate; j++) {
+            if (j > 0) arrangements = saturatingMultiply(arrangements, (unsigned long long)(k - 1 - j));
+            *count = saturatingAdd(*count, arrangements);
+        }
+    } else if (k <= 64) {
+        PathCountState *s = (PathCountState*)calloc(1, sizeof(PathCountState));
+        int *local = (int*)malloc(sizeof(int) * (g->idLimit > 0 ? g->idLimit : 1));
+        exact = s != NULL && local != NULL;
+        if (exact) {
+            // Há no máximo k * 2^k estados; a tabela fica limitada a 2^20 entradas
+            long long states = k < 20 ? (long long)k << k : 1LL << 40;
+            s->memoCapacity = 64;
+            while (s->memoCapacity < 2 * states && s->memoCapacity < (1 << 20)) s->memoCapacity *= 2;
+            s->memoKeys = (unsigned long long*)calloc(s->memoCapacity, sizeof(unsigned long long));
+            s->memoVertices = (int*)malloc(sizeof(int) * s->memoCapacity);
+            s->memoValues = (unsigned long long*)malloc(sizeof(unsigned long long) * s->memoCapacity);
+            exact = s->memoKeys && s->memoVertices && s->memoValues;
+        }
+        if (exact) {
+            for (int i = 0; i < k; i++) local[component.vertices[i]->id] = i;
+            for (int i = 0; i < k; i++) {
+                NeighborCursor c;
+                beginNeighbors(g, component.vertices[i], &c);
+                Vertex *n;
+                while ((n = nextNeighbor(g, component.vertices[i], &c)) != NULL) {
+                    if (n->frequency == frequency) s->adjacency[i] |= 1ULL << local[n->id];
+                }
+            }
+            s->target = local[destination->id];
+            s->maxLength = maxLength;
+            int start = local[origin->id];
+            *count = countPathsFrom(s, start, 1ULL << start);
+            exact = !s->overflow;
+        }
+        if (s != NULL) {
+            free(s->memoKeys);
+            free(s->memoVertices);
+            free(s->memoValues);
+        }
+        free(s);
+        free(local);
+    } else {
+        exact = false;
+    }
+
+    freeTraversalContext(ctx);
+    free(component.vertices);
+    return exact;
+}
+
+/**
+ * @brief Entrega a um sink os pares de vértices com frequência A e B que são vizinhos, considerando todas as direções adjacentes (4 sentidos diretos e 4 sentidos diagonais).
+ * 
+ * A função percorre os membros da frequência A e, para cada um, os membros da frequência B,
+ * pela ordem da lista do grafo (do mais recente para o mais antigo).
+ * 
+ * @param g Pointer para o grafo
+ * @param frequencyA Frequências dos vértices A
+ * @param frequencyB Frequências dos vértices B
+ * @param sink Função chamada para cada par (antena A, antena B)
+ * @param userData Pointer passado sem alterações ao sink
+ * @return int Número de pares entregues
+ */
+int listIntersectionsVisit(Graph *g, char frequencyA, char frequencyB, IntersectionSink sink, void *userData) {
+    INSTRUMENT_FUNCTION();
+    int found = 0;
+    Vertex *vA = g->frequencyTail[(unsigned char)frequencyA];
+    while (vA != NULL) {
+        Vertex *vB = g->frequencyTail[(unsigned char)frequencyB];
+        while (vB != NULL) {
+            // Vizinhos sentido direto
+            int topNeighbor = (vA->x == vB->x && vA->y == vB->y + 1);
+            int bottomNeighbor = (vA->x == vB->x && vA->y == vB->y - 1);
+            int leftNeighbor = (vA->x == vB->x + 1 && vA->y == vB->y);
+            int rightNeighbor = (vA->x == vB->x - 1 && vA->y == vB->y);
+
+            // Vizinhos sentido diagonal
+            int topLeftNeighbor = (vA->x == vB->x + 1 && vA->y == vB->y + 1);
+            int topRightNeighbor = (vA->x == vB->x - 1 && vA->y == vB->y + 1);
+            int bottomLeftNeighbor = (vA->x == vB->x + 1 && vA->y == vB->y - 1);
+            int bottomRightNeighbor = (vA->x == vB->x - 1 && vA->y == vB->y - 1);
+
+            if (topNeighbor || bottomNeighbor || leftNeighbor || rightNeighbor ||
+                topLeftNeighbor || topRightNeighbor || bottomLeftNeighbor || bottomRightNeighbor) {
+                sink(vA, vB, userData);
+                found++;
+            }
+            vB = vB->freqPrev;
+        }
+        vA = vA->freqPrev;
+    }
+    return found;
+}
+
+/**
+ * @brief Verifica e lista de pares de vértices com frequência A e B que são vizinhos, considerando todas as direções adjacentes (4 sentidos diretos e 4 sentidos diagonais).
+ * 
+ * A função percorre todos os vértices do grafo que possuam vizinhos com uma frequencia distinta, 
+ * nos 8 sentidos possíveis da função.
+ * 
+ * @param g Pointer para o grafo
+ * @param frequencyA Frequências dos vértices A
+ * @param frequencyB Frequências dos vértices A
+ */
+void listIntersectionsBetweenFrequencies(Graph *g, char frequencyA, char frequencyB) {
+    INSTRUMENT_FUNCTION();
+    OutputWriter *w = createOutputWriter(stdout, OUTPUT_TEXT);
+    if (w == NULL) return;
+    writeIntersections(w, g, frequencyA, frequencyB);
+    freeOutputWriter(w);
+}
+
+/**
+ * @brief Lista, numa só passagem, todas as intersecções entre antenas de frequências diferentes
+ * 
+ * Para cada antena, consulta no índice de coordenadas apenas 4 das 8 posições vizinhas
+ * (direita, baixo-esquerda, baixo e baixo-direita); as outras 4 são cobertas pela antena
+ * do outro lado, pelo que cada par é encontrado exatamente uma vez e o custo total é
+ * linear no número de antenas.
+ * 
+ * Cada intersecção é entregue ao sink com a antena de menor frequência em primeiro lugar.
+ * Se pairs não for NULL, só são reportados os pares de frequências indicados: pairs contém
+ * pairCount pares consecutivos (por exemplo "ABAC" para os pares A-B e A-C), sem importar a ordem
+ * de cada par.
+ * 
+ * @param g Pointer para o grafo
+ * @param pairs Pares de frequências a reportar, ou NULL para todos
+ * @param pairCount Número de pares em pairs
+ * @param sink Função chamada para cada intersecção encontrada
+ * @param userData Pointer passado sem alterações ao sink
+ * @return int Número de intersecções reportadas
+ */
+int listAllIntersections(Graph *g, const char *pairs, int pairCount, IntersectionSink sink, void *userData){
+    INSTRUMENT_FUNCTION();
+    if (g == NULL || sink == NULL || g->index.capacity == 0) return 0;
+
+    // Matriz de bits FREQUENCY_COUNT x FREQUENCY_COUNT com os pares permitidos
+    unsigned long long allowed[FREQUENCY_COUNT * FREQUENCY_COUNT / 64];
+    if (pairs != NULL) {
+        memset(allowed, 0, sizeof(allowed));
+        for (int i = 0; i < pairCount; i++) {
+            unsigned int a = (unsigned char)pairs[2 * i];
+            unsigned int b = (unsigned char)pairs[2 * i + 1];
+            allowed[(a * FREQUENCY_COUNT + b) / 64] |= 1ULL << ((a * FREQUENCY_COUNT + b) % 64);
+            allowed[(b * FREQUENCY_COUNT + a) / 64] |= 1ULL << ((b * FREQUENCY_COUNT + a) % 64);
+        }
+    }
+
+    // Metade dos 8 sentidos: direita, baixo-esquerda, baixo, baixo-direita
+    static const int offsets[4][2] = { {0, 1}, {1, -1}, {1, 0}, {1, 1} };
+    unsigned int mask = (unsigned int)g->index.capacity - 1;
+    int found = 0;
+
+    Vertex *a = g->vertices;
+    while (a != NULL) {
+        for (int d = 0; d < 4; d++) {
+            int nx = a->x + offsets[d][0];
+            int ny = a->y + offsets[d][1];
+
+            // Percorre o bloco de posições do índice onde ficam as antenas da posição vizinha
+            unsigned int slot = indexSlot(nx, ny, mask);
+            Vertex *b;
+            while ((b = g->index.slots[slot]) != NULL) {
+                slot = (slot + 1) & mask;
+                if (b->x != nx || b->y != ny || b->frequency == a->frequency) continue;
+
+                unsigned int fa = (unsigned char)a->frequency;
+                unsigned int fb = (unsigned char)b->frequency;
+                if (pairs != NULL &&
+                    !(allowed[(fa * FREQUENCY_COUNT + fb) / 64] & (1ULL << ((fa * FREQUENCY_COUNT + fb) % 64)))) {
+                    continue;
+                }
+
+                if (fa < fb) {
+                    sink(a, b, userData);
+                } else {
+                    sink(b, a, userData);
+                }
+                found++;
+            }
+        }
+        a = a->next;
+    }
+    return found;
+}
+
+/** Quatro coordenadas processadas de uma vez pelo computeInterference */
+typedef int InterferenceLanes __attribute__((vector_size(4 * sizeof(int))));
+
+/**
+ * @struct InterferenceBuild
+ * @brief Estado partilhado pelas threads do computeInterference.
+ */
+typedef struct InterferenceBuild{
+    int *xs; // Coordenadas x dos membros, agrupados por frequência
+    int *ys; // Coordenadas y, pela mesma ordem
+    int start[FREQUENCY_COUNT + 1]; // Início dos membros de cada frequência
+    unsigned char order[FREQUENCY_COUNT]; // Frequências com pares, da com mais pares para a com menos
+    int orderCount;
+    int next; // Próxima posição de order a tratar (incrementada atomicamente)
+    int largest; // Número de membros da maior frequência
+    int rows;
+    int cols;
+} InterferenceBuild;
+
+/**
+ * @struct InterferenceWorker
+ * @brief Bitmap e memória auxiliar de uma thread do computeInterference.
+ */
+typedef struct InterferenceWorker{
+    InterferenceBuild *build;
+    uint64_t *bits; // Bitmap onde a thread marca as posições
+    int *positions; // largest posições: bit de cada posição calculada, ou -1 se fora da matriz
+} InterferenceWorker;
+
+/**
+ * @brief Calcula as posições afetadas pelos pares (a, j) do lado da antena a
+ * 
+ * A posição 2a − j de cada membro j é calculada quatro membros de cada vez; as que
+ * ficam fora da matriz (e a do próprio a) ficam com -1.
+ * 
+ * @param b Estado partilhado
+ * @param xs Coordenadas x dos membros da frequência
+ * @param ys Coordenadas y dos membros da frequência
+ * @param count Número de membros
+ * @param a Membro cujo lado é calculado
+ * @param positions Recebe count posições
+ */
+static void interferenceRow(const InterferenceBuild *b, const int *xs, const int *ys, int count, int a,
+                            int *positions){
+    int ax = 2 * xs[a];
+    int ay = 2 * ys[a];
+    int j = 0;
+    for (; j + 4 <= count; j += 4) {
+        InterferenceLanes px, py;
+        memcpy(&px, xs + j, sizeof(px));
+        memcpy(&py, ys + j, sizeof(py));
+        px = ax - px;
+        py = ay - py;
+        // Cada comparação dá -1 (verdadeiro) ou 0 por lane
+        InterferenceLanes inside = (px >= 0) & (px < b->rows) & (py >= 0) & (py < b->cols);
+        InterferenceLanes bit = (px * b->cols + py) | ~inside;
+        memcpy(positions + j, &bit, sizeof(bit));
+    }
+    for (; j < count; j++) {
+        int px = ax - xs[j];
+        int py = ay - ys[j];
+        bool inside = px >= 0 && px < b->rows && py >= 0 && py < b->cols;
+        positions[j] = inside ? px * b->cols + py : -1;
+    }
+    positions[a] = -1;
+}
+
+/**
+ * @brief Ciclo de uma thread do computeInterference: trata frequências até não haver mais
+ * 
+ * @param arg Pointer para o InterferenceWorker
+ * @return void* NULL
+ */
+static void *interferenceWorker(void *arg){
+    InterferenceWorker *w = (InterferenceWorker*)arg;
+    InterferenceBuild *b = w->build;
+    int i;
+    while ((i = __atomic_fetch_add(&b->next, 1, __ATOMIC_RELAXED)) < b->orderCount) {
+        unsigned char f = b->order[i];
+        const int *xs = b->xs + b->start[f];
+        const int *ys = b->ys + b->start[f];
+        int count = b->start[f + 1] - b->start[f];
+        // Cada par ordenado (a, j) dá a posição 2a − j: os dois lados de todos os pares
+        for (int a = 0; a < count; a++) {
+            interferenceRow(b, xs, ys, count, a, w->positions);
+            for (int j = 0; j < count; j++) {
+                int p = w->positions[j];
+                if (p >= 0) w->bits[p >> 6] |= 1ULL << (p & 63);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Calcula as posições da matriz afetadas pelo efeito nefasto
+ * 
+ * Para cada par de antenas A, B da mesma frequência marca 2A − B e 2B − A, se estiverem
+ * dentro da matriz do grafo (g->rows × g->cols). As coordenadas de cada frequência são
+ * copiadas para arrays contíguos e as posições são calculadas quatro de cada vez; as
+ * frequências são repartidas pelas threads, cada uma com o seu bitmap, que no fim são
+ * juntos com OR palavra a palavra.
+ * 
+ * @param g Pointer para o grafo
+ * @param threadCount Número máximo de threads, ou 0 para usar todos os processadores
+ * @return InterferenceMap* Posições afetadas, ou NULL se faltou memória ou a matriz tem
+ *         mais de INT_MAX posições
+ */
+InterferenceMap *computeInterference(Graph *g, int threadCount){
+    INSTRUMENT_FUNCTION();
+    if (g == NULL) return NULL;
+    long long cells = (long long)g->rows * g->cols;
+    if (cells > INT_MAX) return NULL;
+    size_t words = (size_t)((cells + 63) / 64);
+
+    InterferenceMap *map = (InterferenceMap*)calloc(1, sizeof(InterferenceMap));
+    if (map == NULL) return NULL;
+    map->rows = g->rows;
+    map->cols = g->cols;
+    map->bits = (uint64_t*)calloc(words > 0 ? words : 1, sizeof(uint64_t));
+    InterferenceBuild *b = (InterferenceBuild*)calloc(1, sizeof(InterferenceBuild));
+    int members = g->vertexCount > 0 ? g->vertexCount : 1;
+    if (b != NULL) {
+        b->xs = (int*)malloc(sizeof(int) * members);
+        b->ys = (int*)malloc(sizeof(int) * members);
+    }
+    if (map->bits == NULL || b == NULL || b->xs == NULL || b->ys == NULL) {
+        if (b != NULL) {
+            free(b->xs);
+            free(b->ys);
+        }
+        free(b);
+        freeInterferenceMap(map);
+        return NULL;
+    }
+    instrumentAllocation(sizeof(uint64_t) * words);
+    b->rows = g->rows;
+    b->cols = g->cols;
+
+    // Coordenadas agrupadas por frequência e frequências ordenadas pelo número de pares
+    int position = 0;
+    for (int f = 0; f < FREQUENCY_COUNT; f++) {
+        b->start[f] = position;
+        for (Vertex *v = g->frequencyHead[f]; v != NULL; v = v->freqNext) {
+            b->xs[position] = v->x;
+            b->ys[position] = v->y;
+            position++;
+        }
+        int count = g->frequencyCount[f];
+        if (count < 2) continue;
+        if (count > b->largest) b->largest = count;
+        int k = b->orderCount++;
+        while (k > 0 && g->frequencyCount[b->order[k - 1]] < count) {
+            b->order[k] = b->order[k - 1];
+            k--;
+        }
+        b->order[k] = (unsigned char)f;
+    }
+    b->start[FREQUENCY_COUNT] = position;
+
+    if (threadCount <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = cpus > 0 ? (int)cpus : 1;
+    }
+    if (threadCount > b->orderCount) threadCount = b->orderCount > 0 ? b->orderCount : 1;
+
+    // A thread atual marca diretamente no bitmap do resultado
+    InterferenceWorker *workers = (InterferenceWorker*)calloc(threadCount, sizeof(InterferenceWorker));
+    pthread_t *threads = (pthread_t*)malloc(sizeof(pthread_t) * threadCount);
+    bool *started = (bool*)calloc(threadCount, sizeof(bool));
+    bool failed = workers == NULL || threads == NULL || started == NULL;
+    for (int t = 0; t < threadCount && !failed; t++) {
+        workers[t].build = b;
+        workers[t].bits = t == 0 ? map->bits : (uint64_t*)calloc(words > 0 ? words : 1, sizeof(uint64_t));
+        workers[t].positions = (int*)malloc(sizeof(int) * (b->largest > 0 ? b->largest : 1));
+        if (workers[t].bits == NULL || workers[t].positions == NULL) failed = true;
+    }
+    for (int t = 1; t < threadCount && !failed; t++) {
+        started[t] = pthread_create(&threads[t], NULL, interferenceWorker, &workers[t]) == 0;
+    }
+    if (!failed) interferenceWorker(&workers[0]);
+    for (int t = 1; t < threadCount && !failed; t++) {
+        if (!started[t]) continue;
+        pthread_join(threads[t], NULL);
+        for (size_t i = 0; i < words; i++) {
+            map->bits[i] |= workers[t].bits[i];
+        }
+    }
+
+    for (int t = 0; workers != NULL && t < threadCount; t++) {
+        if (t > 0) free(workers[t].bits);
+        free(workers[t].positions);
+    }
+    free(workers);
+    free(threads);
+    free(started);
+    free(b->xs);
+    free(b->ys);
+    free(b);
+    if (failed) {
+        freeInterferenceMap(map);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < words; i++) {
+        map->count += __builtin_popcountll(map->bits[i]);
+    }
+    return map;
+}
+
+/**
+ * @brief Indica se uma posição da matriz é afetada pelo efeito nefasto
+ * 
+ * @param map Pointer para as posições calculadas pelo computeInterference
+ * @param x Linha
+ * @param y Coluna
+ * @return true se a posição é afetada, false se não é ou está fora da matriz
+ */
+bool interferenceAt(const InterferenceMap *map, int x, int y){
+    if (map == NULL || x < 0 || y < 0 || x >= map->rows || y >= map->cols) return false;
+    int p = x * map->cols + y;
+    return (map->bits[p >> 6] >> (p & 63)) & 1;
+}
+
+/**
+ * @brief Entrega cada posição afetada pelo efeito nefasto, linha a linha
+ * 
+ * @param map Pointer para as posições calculadas pelo computeInterference
+ * @param visit Função chamada para cada posição (pode ser NULL para só contar)
+ * @param userData Pointer passado sem alterações à função
+ * @return long long Número de posições entregues
+ */
+long long visitInterference(const InterferenceMap *map, PointVisitor visit, void *userData){
+    INSTRUMENT_FUNCTION();
+    if (map == NULL) return 0;
+    if (visit == NULL) return map->count;
+    size_t words = (size_t)(((long long)map->rows * map->cols + 63) / 64);
+    long long visited = 0;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t bits = map->bits[i];
+        while (bits != 0) {
+            int p = (int)(i * 64) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            visit(p / map->cols, p % map->cols, userData);
+            visited++;
+        }
+    }
+    return visited;
+}
+
+/**
+ * @brief Liberta as posições calculadas pelo computeInterference
+ * 
+ * @param map Pointer para as posições (pode ser NULL)
+ */
+void freeInterferenceMap(InterferenceMap *map){
+    if (map == NULL) return;
+    free(map->bits);
+    free(map);
+}
+
+/**
+ * @brief Liberta toda a memória associada a um grafo
+ * 
+ * @param g Pointer para o grafo
+ */
+void freeGraph(Graph *g){
+    INSTRUMENT_FUNCTION();
+    if (g == NULL) return;
+
+    // Vértices e adjacências vivem nos pools: liberta-se bloco a bloco, sem percorrer a lista
+    poolDestroy(&g->vertexPool);
+    poolDestroy(&g->edgePool);
+    free(g->index.slots);
+    free(g->grid.cells);
+    free(g->grid.best);
+    free(g->grid.bestDistance);
+    free(g->components.parent);
+    free(g->components.size);
+    free(g->freeIds);
+    free(g->rowDigest.hashes);
+    free(g);
+}
+
+/**
+ * @brief Devolve a etiqueta da componente ligada de um vértice, em tempo praticamente constante
+ * 
+ * A etiqueta é o id de um vértice da componente; pode mudar quando um addVertex ou
+ * addEdge junta a componente a outra.
+ * 
+ * @param g Pointer para o grafo
+ * @param v Vértice do grafo
+ * @return int Etiqueta da componente, ou -1 se o vértice não pertence ao grafo
+ */
+int componentOf(Graph *g, Vertex *v){
+    if (g == NULL || v == NULL || v->id < 0 || v->id >= g->components.capacity) return -1;
+    return componentRoot(&g->components, v->id);
+}
+
+/**
+ * @brief Verifica se um vértice é alcançável a partir de outro, sem fazer uma pesquisa
+ * 
+ * @param g Pointer para o grafo
+ * @param a Vértice A
+ * @param b Vértice B
+ * @return true se os dois vértices estão na mesma componente ligada
+ */
+bool sameComponent(Graph *g, Vertex *a, Vertex *b){
+    int componentA = componentOf(g, a);
+    return componentA >= 0 && componentA == componentOf(g, b);
+}
+
+/**
+ * @brief Devolve o número de vértices da componente ligada de um vértice
+ * 
+ * @param g Pointer para o grafo
+ * @param v Vértice do grafo
+ * @return int Número de vértices, ou 0 se o vértice não pertence ao grafo
+ */
+int componentSize(Graph *g, Vertex *v){
+    int root = componentOf(g, v);
+    return root >= 0 ? g->components.size[root] : 0;
+}
+
+/**
+ * @brief Devolve o número de componentes ligadas do grafo
+ * 
+ * @param g Pointer para o grafo
+ * @return int Número de componentes
+ */
+int componentCount(Graph *g){
+    return g != NULL ? g->components.count : 0;
+}
+
+/**
+ * @brief Constrói a representação compacta (CSR) de um grafo
+ * 
+ * Os vértices ficam pela mesma ordem da lista do grafo e as arestas de cada vértice
+ * pela mesma ordem da sua lista de adjacência, pelo que as pesquisas sobre o CSR
+ * produzem exatamente o mesmo resultado que as pesquisas sobre o grafo ligado.
+ * 
+ * @param g Pointer para o grafo de origem
+ * @return CsrGraph* Pointer para o grafo compacto, ou NULL em caso de erro
+ */
+CsrGraph *buildCsrGraph(Graph *g){
+    INSTRUMENT_FUNCTION();
+    if (g == NULL) return NULL;
+
+    CsrGraph *csr = (CsrGraph*)malloc(sizeof(CsrGraph));
+    if (csr == NULL) return NULL;
+
+    int n = g->vertexCount;
+    csr->vertexCount = n;
+    csr->edgeCount = 0;
+    csr->xs = (int*)malloc(sizeof(int) * (n > 0 ? n : 1));
+    csr->ys = (int*)malloc(sizeof(int) * (n > 0 ? n : 1));
+    csr->frequencies = (char*)malloc(sizeof(char) * (n > 0 ? n : 1));
+    csr->offsets = (int*)malloc(sizeof(int) * (n + 1));
+    csr->targets = NULL;
+    csr->mapping = NULL;
+    csr->mappingSize = 0;
+
+    // Traduz o id de cada vértice para a sua posição no CSR
+    int *indexOf = (int*)malloc(sizeof(int) * (g->idLimit > 0 ? g->idLimit : 1));
+
+    if (!csr->xs || !csr->ys || !csr->frequencies || !csr->offsets || !indexOf) {
+        free(indexOf);
+        freeCsrGraph(csr);
+        return NULL;
+    }
+
+    // 1ª passagem: copia os vértices e conta as arestas de cada um
+    int i = 0;
+    Vertex *v = g->vertices;
+    while (v != NULL) {
+        csr->xs[i] = v->x;
+        csr->ys[i] = v->y;
+        csr->frequencies[i] = v->frequency;
+        indexOf[v->id] = i;
+        csr->offsets[i] = csr->edgeCount;
+
+        NeighborCursor c;
+        beginNeighbors(g, v, &c);
+        while (nextNeighbor(g, v, &c) != NULL) {
+            csr->edgeCount++;
+        }
+        i++;
+        v = v->next;
+    }
+    csr->offsets[n] = csr->edgeCount;
+
+    // 2ª passagem: preenche os destinos das arestas com os índices compactos
+    csr->targets = (int*)malloc(sizeof(int) * (csr->edgeCount > 0 ? csr->edgeCount : 1));
+    if (csr->targets == NULL) {
+        free(indexOf);
+        freeCsrGraph(csr);
+        return NULL;
+    }
+    // Estrutura, xs, ys, frequencies, offsets e targets
+    instrumentCount(INSTRUMENT_ALLOCATIONS, 6);
+    instrumentCount(INSTRUMENT_ALLOCATED_BYTES, sizeof(CsrGraph) + (sizeof(int) * 2 + 1) * (size_t)n
+                    + sizeof(int) * ((size_t)n + 1 + (size_t)csr->edgeCount));
+
+    int e = 0;
+    v = g->vertices;
+    while (v != NULL) {
+        NeighborCursor c;
+        beginNeighbors(g, v, &c);
+        Vertex *adj;
+        while ((adj = nextNeighbor(g, v, &c)) != NULL) {
+            csr->targets[e++] = indexOf[adj->id];
+        }
+        v = v->next;
+    }
+
+    free(indexOf);
+    return csr;
+}
+
+/**
+ * @brief Lê um ficheiro de texto diretamente para a representação compacta
+ * 
+ * Usa o readGraphFromFile para construir o grafo e converte-o para CSR,
+ * libertando logo a seguir o grafo ligado intermédio.
+ * 
+ * @param filename Nome de ficheiro de texto a ser lido
+ * @return CsrGraph* Pointer para o grafo compacto, ou NULL em caso de erro
+ */
+CsrGraph *readCsrGraphFromFile(const char *filename){
+    INSTRUMENT_FUNCTION();
+    Graph *g = readGraphFromFile(filename);
+    if (g == NULL) return NULL;
+
+    CsrGraph *csr = buildCsrGraph(g);
+    freeGraph(g);
+    return csr;
+}
+
+/**
+ * @brief Procura o índice de um vértice no grafo compacto
+ * 
+ * @param csr Pointer para o grafo compacto
+ * @param x Coordenada X
+ * @param y Coordenada Y
+ * @param frequency Frequência do vértice
+ * @return int Índice do vértice, ou -1 se não existir
+ */
+int csrFindVertex(CsrGraph *csr, int x, int y, char frequency){
+    for (int i = 0; i < csr->vertexCount; i++) {
+        if (csr->xs[i] == x && csr->ys[i] == y && csr->frequencies[i] == frequency)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Imprime o conteúdo do grafo compacto, no mesmo formato do printGraph
+ * 
+ * @param csr Pointer para o grafo compacto
+ */
+void printCsrGraph(CsrGraph *csr){
+    INSTRUMENT_FUNCTION();
+    for (int i = 0; i < csr->vertexCount; i++) {
+        printf("Antenna (%d, %d) [%c] -> ", csr->xs[i], csr->ys[i], csr->frequencies[i]);
+        for (int e = csr->offsets[i]; e < csr->offsets[i + 1]; e++) {
+            int t = csr->targets[e];
+            printf("(%d, %d) ", csr->xs[t], csr->ys[t]);
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * @brief Depth-First Search (DFS) sobre o grafo compacto
+ * 
+ * Versão iterativa do dfsVisit: cada entrada da pilha guarda o vértice e a próxima
+ * aresta a explorar, o que reproduz a ordem da versão recursiva sem risco de
+ * esgotar a stack em grafos profundos.
+ * 
+ * @param csr Pointer para o grafo compacto
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ */
+void csrDepthFirstSearch(CsrGraph *csr, int startX, int startY, char frequency){
+    INSTRUMENT_FUNCTION();
+    int start = csrFindVertex(csr, startX, startY, frequency);
+    if (start < 0) return;
+
+    int n = csr->vertexCount;
+    bool *visited = (bool*)calloc(n, sizeof(bool));
+    int *stack = (int*)malloc(sizeof(int) * n);
+    int *cursor = (int*)malloc(sizeof(int) * n);
+    if (!visited || !stack || !cursor) {
+        free(visited);
+        free(stack);
+        free(cursor);
+        return;
+    }
+
+    int top = 0;
+    visited[start] = true;
+    printf("Visited: (%d, %d)\n", csr->xs[start], csr->ys[start]);
+    stack[top] = start;
+    cursor[top] = csr->offsets[start];
+    top++;
+
+    while (top > 0) {
+        int v = stack[top - 1];
+        int next = -1;
+
+        // Avança até ao próximo adjacente ainda não visitado
+        while (cursor[top - 1] < csr->offsets[v + 1]) {
+            int t = csr->targets[cursor[top - 1]++];
+            if (!visited[t] && csr->frequencies[t] == csr->frequencies[v]) {
+                next = t;
+                break;
+            }
+        }
+
+        if (next < 0) {
+            top--;
+            continue;
+        }
+
+        visited[next] = true;
+        printf("Visited: (%d, %d)\n", csr->xs[next], csr->ys[next]);
+        stack[top] = next;
+        cursor[top] = csr->offsets[next];
+        top++;
+    }
+
+    free(visited);
+    free(stack);
+    free(cursor);
+}
+
+/**
+ * @brief Breadth-First Search (BFS) sobre o grafo compacto
+ * 
+ * A fila tem capacidade para todos os vértices do grafo, porque cada vértice
+ * só entra na fila uma vez.
+ * 
+ * @param csr Pointer para o grafo compacto
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ */
+void csrBreadthFirstSearch(CsrGraph *csr, int startX, int startY, char frequency){
+    INSTRUMENT_FUNCTION();
+    int start = csrFindVertex(csr, startX, startY, frequency);
+    if (start < 0) return;
+
+    int n = csr->vertexCount;
+    bool *visited = (bool*)calloc(n, sizeof(bool));
+    int *queue = (int*)malloc(sizeof(int) * n);
+    if (!visited || !queue) {
+        free(visited);
+        free(queue);
+        return;
+    }
+
+    int front = 0, back = 0;
+    queue[back++] = start;
+    visited[start] = true;
+
+    while (front < back) {
+        int current = queue[front++];
+        printf("Visited: (%d, %d)\n", csr->xs[current], csr->ys[current]);
+
+        for (int e = csr->offsets[current]; e < csr->offsets[current + 1]; e++) {
+            int t = csr->targets[e];
+            if (!visited[t] && csr->frequencies[t] == csr->frequencies[current]) {
+                visited[t] = true;
+                queue[back++] = t;
+            }
+        }
+    }
+
+    free(visited);
+    free(queue);
+}
+
+/**
+ * @brief Distâncias BFS a partir de um vértice do grafo compacto, com fronteiras em bitsets
+ * 
+ * BFS por níveis com escolha de direção: em cada nível, ou a fronteira procura os seus
+ * adjacentes por visitar (top-down), ou cada vértice por visitar procura um adjacente na
+ * fronteira e pára no primeiro (bottom-up). Os conjuntos são bitsets de 64 vértices por
+ * palavra, pelo que os vértices por visitar e a fronteira são percorridos palavra a palavra.
+ * Numa frequência completa (k antenas) o primeiro nível visita todas e o segundo termina
+ * logo em bottom-up, em vez de percorrer as k² entradas de adjacência.
+ * 
+ * @param csr Pointer para o grafo compacto
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ * @param distances Array com csr->vertexCount posições que recebe o nível de cada vértice
+ *        (-1 se não foi alcançado), ou NULL se só interessa o número de vértices alcançados
+ * @return int Número de vértices alcançados, incluindo o inicial, ou -1 se o vértice não
+ *         existe ou faltou memória
+ */
+int csrBreadthFirstDistances(CsrGraph *csr, int startX, int startY, char frequency, int *distances){
+    INSTRUMENT_FUNCTION();
+    int start = csrFindVertex(csr, startX, startY, frequency);
+    if (start < 0) return -1;
+
+    int n = csr->vertexCount;
+    size_t words = ((size_t)n + 63) / 64;
+    // pending: vértices da mesma frequência ainda por visitar
+    uint64_t *pending = (uint64_t*)calloc(words, sizeof(uint64_t));
+    uint64_t *frontier = (uint64_t*)calloc(words, sizeof(uint64_t));
+    uint64_t *next = (uint64_t*)calloc(words, sizeof(uint64_t));
+    if (!pending || !frontier || !next) {
+        free(pending);
+        free(frontier);
+        free(next);
+        return -1;
+    }
+
+    long long pendingEdges = 0;
+    int pendingCount = 0;
+    for (int i = 0; i < n; i++) {
+        if (distances != NULL) distances[i] = -1;
+        if (i != start && csr->frequencies[i] == frequency) {
+            pending[i >> 6] |= 1ULL << (i & 63);
+            pendingEdges += csr->offsets[i + 1] - csr->offsets[i];
+            pendingCount++;
+        }
+    }
+
+    frontier[start >> 6] |= 1ULL << (start & 63);
+    if (distances != NULL) distances[start] = 0;
+    int frontierCount = 1;
+    long long frontierEdges = csr->offsets[start + 1] - csr->offsets[start];
+    int reached = 1;
+    bool bottomUp = false;
+
+    for (int level = 1; frontierCount > 0 && pendingCount > 0; level++) {
+        if (!bottomUp && frontierEdges > pendingEdges / BFS_ALPHA) {
+            bottomUp = true;
+        } else if (bottomUp && frontierCount < n / BFS_BETA) {
+            bottomUp = false;
+        }
+        memset(next, 0, words * sizeof(uint64_t));
+
+        if (bottomUp) {
+            // Cada vértice por visitar procura um adjacente na fronteira
+            for (size_t w = 0; w < words; w++) {
+                uint64_t bits = pending[w];
+                while (bits != 0) {
+                    int u = (int)(w * 64) + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+                        int t = csr->targets[e];
+                        if (frontier[t >> 6] & (1ULL << (t & 63))) {
+                            next[w] |= 1ULL << (u & 63);
+                            break;
+                        }
+                    }
+                }
+                pending[w] &= ~next[w];
+            }
+        } else {
+            // Cada vértice da fronteira marca os seus adjacentes por visitar
+            for (size_t w = 0; w < words; w++) {
+                uint64_t bits = frontier[w];
+                while (bits != 0) {
+                    int v = (int)(w * 64) + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+                        int t = csr->targets[e];
+                        uint64_t mask = 1ULL << (t & 63);
+                        if (pending[t >> 6] & mask) {
+                            pending[t >> 6] &= ~mask;
+                            next[t >> 6] |= mask;
+                        }
+                    }
+                }
+            }
+        }
+
+        // A nova fronteira são os vértices visitados neste nível
+        frontierCount = 0;
+        frontierEdges = 0;
+        for (size_t w = 0; w < words; w++) {
+            uint64_t bits = next[w];
+            frontierCount += __builtin_popcountll(bits);
+            while (bits != 0) {
+                int u = (int)(w * 64) + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                if (distances != NULL) distances[u] = level;
+                frontierEdges += csr->offsets[u + 1] - csr->offsets[u];
+            }
+        }
+        uint64_t *swap = frontier;
+        frontier = next;
+        next = swap;
+        pendingCount -= frontierCount;
+        pendingEdges -= frontierEdges;
+        reached += frontierCount;
+    }
+
+    free(pending);
+    free(frontier);
+    free(next);
+    return reached;
+}
+
+/**
+ * @brief Encontra e imprime todos os caminhos entre dois vértices do grafo compacto
+ * 
+ * Versão iterativa do findPathsRecursive: o array path guarda o caminho atual e
+ * o array cursor guarda, para cada posição do caminho, a próxima aresta a explorar.
+ * 
+ * @param csr Pointer para o grafo compacto
+ * @param x1 Coordenada X do vértice de origem
+ * @param y1 Coordenada Y do vértice de origem
+ * @param x2 Coordenada X do vértice de destino
+ * @param y2 Coordenada Y do vértice de destino
+ * @param frequency Frequência comum requerida para os vértices do caminho
+ */
+void csrFindAllPaths(CsrGraph *csr, int x1, int y1, int x2, int y2, char frequency){
+    INSTRUMENT_FUNCTION();
+    int origin = csrFindVertex(csr, x1, y1, frequency);
+    int destination = csrFindVertex(csr, x2, y2, frequency);
+    if (origin < 0 || destination < 0) return;
+
+    int n = csr->vertexCount;
+    bool *visited = (bool*)calloc(n, sizeof(bool));
+    int *path = (int*)malloc(sizeof(int) * n);
+    int *cursor = (int*)malloc(sizeof(int) * n);
+    if (!visited || !path || !cursor) {
+        free(visited);
+        free(path);
+        free(cursor);
+        return;
+    }
+
+    int length = 0;
+    visited[origin] = true;
+    path[length] = origin;
+    cursor[length] = csr->offsets[origin];
+    length++;
+
+    while (length > 0) {
+        int current = path[length - 1];
+
+        // Chegou ao destino: imprime o caminho e recua
+        if (current == destination) {
+            printf("Path Founded: ");
+            for (int i = 0; i < length; i++) {
+                printf("(%d,%d)", csr->xs[path[i]], csr->ys[path[i]]);
+                if (i < length - 1) printf(" -> ");
+            }
+            printf("\n");
+            visited[current] = false;
+            length--;
+            continue;
+        }
+
+        int next = -1;
+        while (cursor[length - 1] < csr->offsets[current + 1]) {
+            int t = csr->targets[cursor[length - 1]++];
+            if (!visited[t] && csr->frequencies[t] == csr->frequencies[current]) {
+                next = t;
+                break;
+            }
+        }
+
+        // Sem mais adjacentes: desmarca o vértice atual e recua
+        if (next < 0) {
+            visited[current] = false;
+            length--;
+            continue;
+        }
+
+        visited[next] = true;
+        path[length] = next;
+        cursor[length] = csr->offsets[next];
+        length++;
+    }
+
+    free(visited);
+    free(path);
+    free(cursor);
+}
+
+/**
+ * @brief Liberta toda a memória associada a um grafo compacto
+ * 
+ * @param csr Pointer para o grafo compacto
  */
-void writeGraphToBinary(const char *filename, Graph *g) {
+void freeCsrGraph(CsrGraph *csr){
+    INSTRUMENT_FUNCTION();
+    if (csr == NULL) return;
+
+    // Os arrays de um snapshot mapeado pertencem ao mapeamento
+    if (csr->mapping != NULL) {
+        munmap(csr->mapping, csr->mappingSize);
+        free(csr);
+        return;
+    }
+
+    free(csr->xs);
+    free(csr->ys);
+    free(csr->frequencies);
+    free(csr->offsets);
+    free(csr->targets);
+    free(csr);
+}
+
+/**
+ * @brief Calcula o checksum FNV-1a de 64 bits de um bloco de memória
+ * 
+ * @param data Início do bloco
+ * @param size Tamanho do bloco em bytes
+ * @param hash Valor inicial (ou o resultado de um bloco anterior)
+ * @return uint64_t Checksum acumulado
+ */
+static uint64_t snapshotChecksum(const void *data, size_t size, uint64_t hash){
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Arredonda uma posição do ficheiro para o próximo múltiplo de 8
+ * 
+ * @param offset Posição no ficheiro
+ * @return uint64_t Posição alinhada
+ */
+static uint64_t snapshotAlign(uint64_t offset){
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+/**
+ * @brief Escreve um grafo compacto num ficheiro de snapshot
+ * 
+ * Cada array é escrito de uma só vez, numa posição alinhada a 8 bytes, depois de um
+ * cabeçalho com versão e checksum. O snapshot pode depois ser aberto com o openCsrSnapshot
+ * sem reconstruir o grafo.
+ * 
+ * @param filename Nome do ficheiro de snapshot
+ * @param csr Pointer para o grafo compacto
+ * @return true se o ficheiro foi escrito, false em caso de erro
+ */
+bool writeCsrSnapshot(const char *filename, CsrGraph *csr){
+    INSTRUMENT_FUNCTION();
+    if (csr == NULL) return false;
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    h.version = SNAPSHOT_VERSION;
+    h.byteOrder = SNAPSHOT_BYTE_ORDER;
+    h.vertexCount = csr->vertexCount;
+    h.edgeCount = csr->edgeCount;
+
+    // Posição de cada array, pela ordem em que são escritos
+    const void *sections[5] = { csr->xs, csr->ys, csr->frequencies, csr->offsets, csr->targets };
+    size_t sizes[5] = {
+        sizeof(int) * (size_t)csr->vertexCount,
+        sizeof(int) * (size_t)csr->vertexCount,
+        sizeof(char) * (size_t)csr->vertexCount,
+        sizeof(int) * ((size_t)csr->vertexCount + 1),
+        sizeof(int) * (size_t)csr->edgeCount
+    };
+    uint64_t offsets[5];
+    uint64_t position = snapshotAlign(sizeof(SnapshotHeader));
+    for (int i = 0; i < 5; i++) {
+        offsets[i] = position;
+        position = snapshotAlign(position + sizes[i]);
+    }
+    h.xsOffset = offsets[0];
+    h.ysOffset = offsets[1];
+    h.frequenciesOffset = offsets[2];
+    h.offsetsOffset = offsets[3];
+    h.targetsOffset = offsets[4];
+    h.fileSize = position;
+
+    // O checksum cobre os arrays e o enchimento (zeros) entre eles
+    static const char padding[8] = { 0 };
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint64_t written = snapshotAlign(sizeof(SnapshotHeader));
+    hash = snapshotChecksum(padding, written - sizeof(SnapshotHeader), hash);
+    for (int i = 0; i < 5; i++) {
+        hash = snapshotChecksum(sections[i], sizes[i], hash);
+        hash = snapshotChecksum(padding, snapshotAlign(offsets[i] + sizes[i]) - (offsets[i] + sizes[i]), hash);
+    }
+    h.checksum = hash;
+
     FILE *f = fopen(filename, "wb");
-    if (!f) return;
+    if (!f) return false;
 
-    // Conta vértices
-    int vertexCount = 0;
-    Vertex *v = g->vertices;
-    while (v) {
-        vertexCount++;
-        v = v->next;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && fwrite(padding, 1, written - sizeof(SnapshotHeader), f) == written - sizeof(SnapshotHeader);
+    for (int i = 0; i < 5 && ok; i++) {
+        size_t pad = snapshotAlign(offsets[i] + sizes[i]) - (offsets[i] + sizes[i]);
+        ok = fwrite(sections[i], 1, sizes[i], f) == sizes[i];
+        ok = ok && fwrite(padding, 1, pad, f) == pad;
     }
-    
-    //parametros da fwrite e fread (*ptr, size_t size, size_t count, file *stream)
-    fwrite(&vertexCount, sizeof(int), 1, f);
 
-    // Escreve vértices
-    v = g->vertices;
-    while (v) {
-        fwrite(&v->x, sizeof(int), 1, f);
-        fwrite(&v->y, sizeof(int), 1, f);
-        fwrite(&v->frequency, sizeof(char), 1, f);
-        v = v->next;
+    if (fclose(f) != 0) ok = false;
+    if (ok) instrumentCount(INSTRUMENT_BYTES_WRITTEN, position);
+    return ok;
+}
+
+/**
+ * @brief Escreve um grafo num ficheiro de snapshot, convertendo-o para CSR
+ * 
+ * @param filename Nome do ficheiro de snapshot
+ * @param g Pointer para o grafo
+ * @return true se o ficheiro foi escrito, false em caso de erro
+ */
+bool writeGraphSnapshot(const char *filename, Graph *g){
+    INSTRUMENT_FUNCTION();
+    CsrGraph *csr = buildCsrGraph(g);
+    if (csr == NULL) return false;
+
+    bool ok = writeCsrSnapshot(filename, csr);
+    freeCsrGraph(csr);
+    return ok;
+}
+
+/**
+ * @brief Verifica se um array de um snapshot cabe no ficheiro, depois do cabeçalho
+ * 
+ * As contas são feitas sem somas que possam dar a volta, para um cabeçalho corrompido
+ * não passar como válido.
+ * 
+ * @param offset Posição do array no ficheiro
+ * @param count Número de elementos
+ * @param elementSize Tamanho de cada elemento
+ * @param alignment Alinhamento exigido da posição
+ * @param size Tamanho do ficheiro
+ * @return true se o array está todo dentro do ficheiro
+ */
+static bool snapshotSectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t alignment, uint64_t size){
+    return offset % alignment == 0 && offset >= sizeof(SnapshotHeader) && offset <= size
+        && count <= (size - offset) / elementSize;
+}
+
+/**
+ * @brief Verifica a estrutura dos arrays de ligações de um snapshot
+ * 
+ * offsets tem de começar em 0, nunca diminuir e acabar em m, e todos os destinos têm de
+ * ser vértices existentes, para nenhuma pesquisa ler fora do mapeamento.
+ * 
+ * @param offsets Início das ligações de cada vértice (n + 1 posições)
+ * @param targets Destino de cada ligação (m posições)
+ * @param n Número de vértices
+ * @param m Número de ligações
+ * @return true se a estrutura é válida
+ */
+static bool snapshotLinksValid(const int *offsets, const int *targets, int n, int m){
+    if (offsets[0] != 0 || offsets[n] != m) return false;
+    for (int i = 0; i < n; i++) {
+        if (offsets[i + 1] < offsets[i]) return false;
+    }
+    for (int e = 0; e < m; e++) {
+        if (targets[e] < 0 || targets[e] >= n) return false;
     }
+    return true;
+}
 
-    // Escreve adjacências (coordenadas dos vértices adjacentes)
-    v = g->vertices;
-    while (v) {
-        // Conta adjacentes
-        int adjCount = 0;
-        AdjList *adj = v->adjacents;
-        while (adj) {
-            adjCount++;
-            adj = adj->next;
+/**
+ * @brief Abre um snapshot mapeando-o diretamente em memória
+ * 
+ * Os arrays do CsrGraph devolvido apontam para o ficheiro mapeado, pelo que o grafo fica
+ * disponível para pesquisas logo após o mmap. O cabeçalho é sempre validado (identificação,
+ * versão, ordem dos bytes e limites dos arrays), tal como a estrutura das ligações (uma
+ * passagem por offsets e targets), pelo que um ficheiro truncado ou corrompido nunca leva
+ * as pesquisas para fora do mapeamento. A verificação do checksum percorre o ficheiro todo
+ * e deteta também alterações às coordenadas e frequências; pode ser dispensada quando o
+ * ficheiro é de confiança.
+ * 
+ * @param filename Nome do ficheiro de snapshot
+ * @param verifyChecksum true para confirmar o checksum do conteúdo
+ * @return CsrGraph* Pointer para o grafo compacto, ou NULL se o ficheiro for inválido
+ */
+CsrGraph *openCsrSnapshot(const char *filename, bool verifyChecksum){
+    INSTRUMENT_FUNCTION();
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    instrumentCount(INSTRUMENT_BYTES_READ, size);
+    void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    const SnapshotHeader *h = (const SnapshotHeader*)data;
+    uint64_t n = (uint64_t)(h->vertexCount >= 0 ? h->vertexCount : 0);
+    uint64_t m = (uint64_t)(h->edgeCount >= 0 ? h->edgeCount : 0);
+
+    bool valid = memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0
+        && h->version == SNAPSHOT_VERSION
+        && h->byteOrder == SNAPSHOT_BYTE_ORDER
+        && h->vertexCount >= 0 && h->edgeCount >= 0
+        && h->fileSize == size
+        && snapshotSectionFits(h->xsOffset, n, sizeof(int), 8, size)
+        && snapshotSectionFits(h->ysOffset, n, sizeof(int), 8, size)
+        && snapshotSectionFits(h->frequenciesOffset, n, 1, 1, size)
+        && snapshotSectionFits(h->offsetsOffset, n + 1, sizeof(int), 8, size)
+        && snapshotSectionFits(h->targetsOffset, m, sizeof(int), 8, size);
+    if (valid) {
+        valid = snapshotLinksValid((const int*)((const char*)data + h->offsetsOffset),
+                                   (const int*)((const char*)data + h->targetsOffset),
+                                   h->vertexCount, h->edgeCount);
+    }
+
+    if (valid && verifyChecksum) {
+        uint64_t hash = snapshotChecksum((const char*)data + sizeof(SnapshotHeader),
+                                         size - sizeof(SnapshotHeader), 0xCBF29CE484222325ULL);
+        valid = hash == h->checksum;
+    }
+
+    CsrGraph *csr = valid ? (CsrGraph*)malloc(sizeof(CsrGraph)) : NULL;
+    if (csr == NULL) {
+        munmap(data, size);
+        return NULL;
+    }
+
+    char *base = (char*)data;
+    csr->vertexCount = h->vertexCount;
+    csr->edgeCount = h->edgeCount;
+    csr->xs = (int*)(base + h->xsOffset);
+    csr->ys = (int*)(base + h->ysOffset);
+    csr->frequencies = base + h->frequenciesOffset;
+    csr->offsets = (int*)(base + h->offsetsOffset);
+    csr->targets = (int*)(base + h->targetsOffset);
+    csr->mapping = data;
+    csr->mappingSize = size;
+    return csr;
+}
+
+/**
+ * @struct TilePlacement
+ * @brief Bloco já escrito pelo writeTiledGraph, antes de o diretório ter dimensões conhecidas.
+ */
+typedef struct TilePlacement{
+    int tileRow;
+    int tileCol;
+    TileEntry entry;
+} TilePlacement;
+
+/**
+ * @struct TiledWriter
+ * @brief Estado do writeTiledGraph: antenas da faixa de blocos atual e blocos já escritos.
+ */
+typedef struct TiledWriter{
+    FILE *out;
+    int tileSize;
+    AntennaCell *band; // Antenas das tileSize linhas da faixa atual
+    int bandCount;
+    int bandCapacity;
+    AntennaCell *sorted; // Antenas da faixa agrupadas por bloco
+    int sortedCapacity;
+    TilePlacement *placements;
+    int placementCount;
+    int placementCapacity;
+    bool failed;
+} TiledWriter;
+
+/** @brief Ordena antenas por linha, coluna e frequência (ordem das antenas de cada bloco) */
+static int compareCells(const void *a, const void *b){
+    const AntennaCell *ca = (const AntennaCell*)a;
+    const AntennaCell *cb = (const AntennaCell*)b;
+    if (ca->x != cb->x) return ca->x < cb->x ? -1 : 1;
+    if (ca->y != cb->y) return ca->y < cb->y ? -1 : 1;
+    return (unsigned char)ca->frequency - (unsigned char)cb->frequency;
+}
+
+/**
+ * @brief Escreve os blocos de uma faixa de tileSize linhas e esvazia a faixa
+ * 
+ * As antenas da faixa são agrupadas por coluna de blocos (ordenação por contagem) e
+ * cada bloco é ordenado e escrito seguido no ficheiro.
+ * 
+ * @param w Estado do writeTiledGraph
+ * @param tileRow Linha de blocos da faixa
+ */
+static void flushTiledBand(TiledWriter *w, int tileRow){
+    if (w->bandCount == 0 || w->failed) {
+        w->bandCount = 0;
+        return;
+    }
+
+    int tileCols = 0;
+    for (int i = 0; i < w->bandCount; i++) {
+        int col = w->band[i].y / w->tileSize;
+        if (col + 1 > tileCols) tileCols = col + 1;
+    }
+    int *start = (int*)calloc((size_t)tileCols + 1, sizeof(int));
+    if (w->sortedCapacity < w->bandCount) {
+        AntennaCell *sorted = (AntennaCell*)realloc(w->sorted, sizeof(AntennaCell) * w->bandCapacity);
+        if (sorted != NULL) {
+            w->sorted = sorted;
+            w->sortedCapacity = w->bandCapacity;
         }
-        fwrite(&adjCount, sizeof(int), 1, f);
+    }
+    if (start == NULL || w->sortedCapacity < w->bandCount) {
+        free(start);
+        w->failed = true;
+        return;
+    }
+
+    for (int i = 0; i < w->bandCount; i++) start[w->band[i].y / w->tileSize + 1]++;
+    for (int c = 0; c < tileCols; c++) start[c + 1] += start[c];
+    for (int i = 0; i < w->bandCount; i++) {
+        w->sorted[start[w->band[i].y / w->tileSize]++] = w->band[i];
+    }
+
+    // start[c] aponta agora para o fim do bloco c
+    int begin = 0;
+    for (int c = 0; c < tileCols && !w->failed; c++) {
+        int count = start[c] - begin;
+        if (count == 0) continue;
+        AntennaCell *cells = w->sorted + begin;
+        qsort(cells, count, sizeof(AntennaCell), compareCells);
+
+        if (w->placementCount == w->placementCapacity) {
+            int newCapacity = w->placementCapacity > 0 ? w->placementCapacity * 2 : 64;
+            TilePlacement *placements = (TilePlacement*)realloc(w->placements, sizeof(TilePlacement) * newCapacity);
+            if (placements == NULL) {
+                w->failed = true;
+                break;
+            }
+            w->placements = placements;
+            w->placementCapacity = newCapacity;
+        }
+        TilePlacement *p = &w->placements[w->placementCount++];
+        memset(p, 0, sizeof(TilePlacement));
+        p->tileRow = tileRow;
+        p->tileCol = c;
+        p->entry.offset = (uint64_t)ftell(w->out);
+        p->entry.count = (uint32_t)count;
+        for (int i = 0; i < count; i++) {
+            unsigned char f = (unsigned char)cells[i].frequency;
+            p->entry.frequencies[f >> 6] |= 1ULL << (f & 63);
+        }
+        if (fwrite(cells, sizeof(AntennaCell), count, w->out) != (size_t)count) w->failed = true;
+        begin = start[c];
+    }
+    free(start);
+    w->bandCount = 0;
+}
+
+/**
+ * @brief Converte um ficheiro de texto num ficheiro de blocos para o openTiledGraph
+ * 
+ * O ficheiro de texto é lido linha a linha e só as antenas de uma faixa de tileSize
+ * linhas ficam em memória, pelo que a matriz pode ser maior do que a memória disponível.
+ * As coordenadas são as mesmas do readGraphFromFile.
+ * 
+ * @param textFile Nome do ficheiro de texto
+ * @param tiledFile Nome do ficheiro de blocos a criar
+ * @param tileSize Lado de cada bloco
+ * @return true se o ficheiro foi criado, false se um dos ficheiros não abriu,
+ *         faltou memória ou a escrita falhou
+ */
+bool writeTiledGraph(const char *textFile, const char *tiledFile, int tileSize){
+    INSTRUMENT_FUNCTION();
+    if (tileSize <= 0) return false;
+    FILE *in = fopen(textFile, "r");
+    if (in == NULL) return false;
+    FILE *out = fopen(tiledFile, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+
+    TiledHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TILED_MAGIC, sizeof(TILED_MAGIC));
+    h.version = TILED_VERSION;
+    h.byteOrder = SNAPSHOT_BYTE_ORDER;
+    h.tileSize = tileSize;
+
+    TiledWriter w;
+    memset(&w, 0, sizeof(w));
+    w.out = out;
+    w.tileSize = tileSize;
+    // O cabeçalho é reescrito no fim, com as dimensões e o diretório
+    if (fwrite(&h, sizeof(h), 1, out) != 1) w.failed = true;
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t lineLength;
+    int x = 0;
+    while (!w.failed && (lineLength = getline(&line, &len, in)) != -1) {
+        instrumentCount(INSTRUMENT_BYTES_READ, (unsigned long long)lineLength);
+        if (x > 0 && x % tileSize == 0) flushTiledBand(&w, x / tileSize - 1);
+        int y = 0;
+        for (int i = 0; line[i] != '\0' && line[i] != '\n'; i++) {
+            if (line[i] == ' ' || line[i] == '\t') continue;
+            if (line[i] != '.') {
+                if (w.bandCount == w.bandCapacity) {
+                    int newCapacity = w.bandCapacity > 0 ? w.bandCapacity * 2 : 256;
+                    AntennaCell *band = (AntennaCell*)realloc(w.band, sizeof(AntennaCell) * newCapacity);
+                    if (band == NULL) {
+                        w.failed = true;
+                        break;
+                    }
+                    w.band = band;
+                    w.bandCapacity = newCapacity;
+                }
+                // Sem lixo no enchimento da estrutura, para o ficheiro ser sempre igual
+                AntennaCell *cell = &w.band[w.bandCount++];
+                memset(cell, 0, sizeof(AntennaCell));
+                cell->x = x;
+                cell->y = y;
+                cell->frequency = line[i];
+                h.antennaCount++;
+            }
+            y++;
+        }
+        if (y > h.cols) h.cols = y;
+        x++;
+    }
+    if (x > 0) flushTiledBand(&w, (x - 1) / tileSize);
+    free(line);
+    fclose(in);
+
+    h.rows = x;
+    h.tileRows = (h.rows + tileSize - 1) / tileSize;
+    h.tileCols = (h.cols + tileSize - 1) / tileSize;
+    size_t tileCount = (size_t)h.tileRows * h.tileCols;
+    TileEntry *directory = (TileEntry*)calloc(tileCount > 0 ? tileCount : 1, sizeof(TileEntry));
+    if (directory == NULL) w.failed = true;
+    for (int i = 0; i < w.placementCount && !w.failed; i++) {
+        TilePlacement *p = &w.placements[i];
+        directory[(size_t)p->tileRow * h.tileCols + p->tileCol] = p->entry;
+    }
+
+    if (!w.failed) {
+        h.directoryOffset = (uint64_t)ftell(out);
+        if (fwrite(directory, sizeof(TileEntry), tileCount, out) != tileCount
+            || fseek(out, 0, SEEK_SET) != 0
+            || fwrite(&h, sizeof(h), 1, out) != 1) {
+            w.failed = true;
+        }
+    }
+    if (!w.failed) {
+        instrumentCount(INSTRUMENT_BYTES_WRITTEN,
+                        h.directoryOffset + sizeof(TileEntry) * (unsigned long long)tileCount);
+    }
+
+    free(directory);
+    free(w.band);
+    free(w.sorted);
+    free(w.placements);
+    if (fclose(out) != 0) w.failed = true;
+    if (w.failed) remove(tiledFile);
+    return !w.failed;
+}
+
+/**
+ * @brief Abre um ficheiro de blocos criado pelo writeTiledGraph
+ * 
+ * Só o cabeçalho e o diretório são lidos; as antenas de cada bloco são lidas quando
+ * uma consulta precisa delas.
+ * 
+ * @param filename Nome do ficheiro de blocos
+ * @param memoryBudget Bytes máximos dos blocos carregados ao mesmo tempo (0 = sem limite);
+ *        os blocos em uso por uma consulta ficam sempre carregados
+ * @param radius Distância máxima das ligações entre antenas da mesma frequência, ou 0
+ *        para ligar toda a frequência
+ * @return TiledGraph* Pointer para o grafo, ou NULL se o ficheiro não abriu, é inválido
+ *         ou faltou memória
+ */
+TiledGraph *openTiledGraph(const char *filename, size_t memoryBudget, int radius){
+    INSTRUMENT_FUNCTION();
+    if (radius < 0) return NULL;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    TiledHeader h;
+    bool valid = fstat(fd, &st) == 0 && pread(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h);
+    size_t tileCount = 0;
+    if (valid) {
+        tileCount = (size_t)(h.tileRows > 0 ? h.tileRows : 0) * (size_t)(h.tileCols > 0 ? h.tileCols : 0);
+        valid = memcmp(h.magic, TILED_MAGIC, sizeof(TILED_MAGIC)) == 0
+            && h.version == TILED_VERSION
+            && h.byteOrder == SNAPSHOT_BYTE_ORDER
+            && h.tileSize > 0 && h.rows >= 0 && h.cols >= 0
+            && h.tileRows == (h.rows + h.tileSize - 1) / h.tileSize
+            && h.tileCols == (h.cols + h.tileSize - 1) / h.tileSize
+            && h.directoryOffset + sizeof(TileEntry) * (uint64_t)tileCount <= (uint64_t)st.st_size;
+    }
+
+    TiledGraph *t = valid ? (TiledGraph*)calloc(1, sizeof(TiledGraph)) : NULL;
+    if (t != NULL) {
+        t->directory = (TileEntry*)malloc(sizeof(TileEntry) * (tileCount > 0 ? tileCount : 1));
+        t->tiles = (Tile**)calloc(tileCount > 0 ? tileCount : 1, sizeof(Tile*));
+    }
+    size_t directorySize = sizeof(TileEntry) * tileCount;
+    if (t == NULL || t->directory == NULL || t->tiles == NULL
+        || pread(fd, t->directory, directorySize, (off_t)h.directoryOffset) != (ssize_t)directorySize) {
+        if (t != NULL) {
+            free(t->directory);
+            free(t->tiles);
+            free(t);
+        }
+        close(fd);
+        return NULL;
+    }
+    instrumentCount(INSTRUMENT_BYTES_READ, sizeof(h) + directorySize);
+
+    // Cada bloco tem de caber no ficheiro antes do diretório
+    for (size_t i = 0; i < tileCount; i++) {
+        TileEntry *e = &t->directory[i];
+        if (e->count > 0 && (e->offset < sizeof(h)
+            || e->offset + sizeof(AntennaCell) * (uint64_t)e->count > h.directoryOffset)) {
+            free(t->directory);
+            free(t->tiles);
+            free(t);
+            close(fd);
+            return NULL;
+        }
+    }
+
+    t->fd = fd;
+    t->header = h;
+    t->memoryBudget = memoryBudget;
+    t->radius = radius;
+    return t;
+}
+
+/** @brief Memória ocupada por um bloco carregado */
+static size_t tileBytes(const Tile *tile){
+    return sizeof(Tile) + sizeof(AntennaCell) * (size_t)tile->count;
+}
+
+/**
+ * @brief Descarrega os blocos usados menos recentemente até respeitar o orçamento
+ * 
+ * @param t Pointer para o grafo em blocos
+ */
+static void tileTrim(TiledGraph *t){
+    Tile *tile = t->oldest;
+    while (t->memoryBudget > 0 && t->memoryUsed > t->memoryBudget && tile != NULL) {
+        Tile *newer = tile->newer;
+        if (tile->pins == 0) {
+            if (tile->newer != NULL) tile->newer->older = tile->older; else t->newest = tile->older;
+            if (tile->older != NULL) tile->older->newer = tile->newer; else t->oldest = tile->newer;
+            t->tiles[tile->index] = NULL;
+            t->memoryUsed -= tileBytes(tile);
+            t->evictions++;
+            free(tile->cells);
+            free(tile);
+        }
+        tile = newer;
+    }
+}
+
+/**
+ * @brief Obtém um bloco, lendo-o do ficheiro se não estiver carregado, e fixa-o em memória
+ * 
+ * O bloco fica no início da lista LRU e não é descarregado até ao tileRelease.
+ * 
+ * @param t Pointer para o grafo em blocos
+ * @param index Posição do bloco no diretório
+ * @return Tile* Bloco carregado, ou NULL se o bloco não tem antenas, a leitura falhou
+ *         ou faltou memória
+ */
+static Tile *tileAcquire(TiledGraph *t, int index){
+    if (t->directory[index].count == 0) return NULL;
+    Tile *tile = t->tiles[index];
+    if (tile != NULL) {
+        t->hits++;
+        // Passa para o início da lista LRU
+        if (tile != t->newest) {
+            tile->newer->older = tile->older;
+            if (tile->older != NULL) tile->older->newer = tile->newer; else t->oldest = tile->newer;
+            tile->older = t->newest;
+            tile->newer = NULL;
+            t->newest->newer = tile;
+            t->newest = tile;
+        }
+        tile->pins++;
+        return tile;
+    }
+
+    const TileEntry *e = &t->directory[index];
+    size_t size = sizeof(AntennaCell) * (size_t)e->count;
+    tile = (Tile*)calloc(1, sizeof(Tile));
+    if (tile != NULL) tile->cells = (AntennaCell*)malloc(size);
+    if (tile == NULL || tile->cells == NULL
+        || pread(t->fd, tile->cells, size, (off_t)e->offset) != (ssize_t)size) {
+        if (tile != NULL) free(tile->cells);
+        free(tile);
+        return NULL;
+    }
+    instrumentCount(INSTRUMENT_BYTES_READ, size);
+    instrumentAllocation(sizeof(Tile) + size);
+    t->misses++;
+    tile->index = index;
+    tile->count = (int)e->count;
+    tile->pins = 1;
+    tile->older = t->newest;
+    if (t->newest != NULL) t->newest->newer = tile; else t->oldest = tile;
+    t->newest = tile;
+    t->tiles[index] = tile;
+    t->memoryUsed += tileBytes(tile);
+    tileTrim(t);
+    return tile;
+}
+
+/** @brief Liberta um bloco obtido pelo tileAcquire, que pode voltar a ser descarregado */
+static void tileRelease(TiledGraph *t, Tile *tile){
+    if (tile == NULL) return;
+    tile->pins--;
+    tileTrim(t);
+}
+
+/**
+ * @brief Procura uma antena num bloco carregado, por pesquisa binária
+ * 
+ * @param tile Bloco carregado
+ * @param x Linha
+ * @param y Coluna
+ * @param frequency Frequência
+ * @return const AntennaCell* Antena, ou NULL se não existe no bloco
+ */
+static const AntennaCell *tileFind(const Tile *tile, int x, int y, char frequency){
+    AntennaCell key;
+    key.x = x;
+    key.y = y;
+    key.frequency = frequency;
+    return (const AntennaCell*)bsearch(&key, tile->cells, tile->count, sizeof(AntennaCell), compareCells);
+}
+
+/**
+ * @brief Primeira antena de um bloco na linha x ou numa linha seguinte
+ * 
+ * @param tile Bloco carregado
+ * @param x Linha
+ * @return int Posição da antena em tile->cells (tile->count se não existe)
+ */
+static int tileLowerRow(const Tile *tile, int x){
+    int low = 0, high = tile->count;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (tile->cells[middle].x < x) low = middle + 1; else high = middle;
+    }
+    return low;
+}
+
+/**
+ * @brief Posição no diretório do bloco que contém uma posição da matriz
+ * 
+ * @param t Pointer para o grafo em blocos
+ * @param x Linha
+ * @param y Coluna
+ * @return int Posição do bloco, ou -1 se a posição está fora da matriz
+ */
+static int tileIndexOf(const TiledGraph *t, int x, int y){
+    if (x < 0 || y < 0 || x >= t->header.rows || y >= t->header.cols) return -1;
+    return (x / t->header.tileSize) * t->header.tileCols + y / t->header.tileSize;
+}
+
+/** @brief Indica se um bloco tem antenas de uma frequência, sem o carregar */
+static bool tileHasFrequency(const TiledGraph *t, int index, char frequency){
+    unsigned char f = (unsigned char)frequency;
+    return (t->directory[index].frequencies[f >> 6] >> (f & 63)) & 1;
+}
+
+/**
+ * @brief Procura uma antena do grafo em blocos
+ * 
+ * @param t Pointer para o grafo em blocos
+ * @param x Linha
+ * @param y Coluna
+ * @param frequency Frequência
+ * @param cell Recebe uma cópia da antena (pode ser NULL)
+ * @return true se a antena existe, false se não existe ou o bloco não pôde ser lido
+ */
+bool tiledFindAntenna(TiledGraph *t, int x, int y, char frequency, AntennaCell *cell){
+    INSTRUMENT_FUNCTION();
+    if (t == NULL) return false;
+    int index = tileIndexOf(t, x, y);
+    if (index < 0 || !tileHasFrequency(t, index, frequency)) return false;
+    Tile *tile = tileAcquire(t, index);
+    if (tile == NULL) return false;
+    const AntennaCell *found = tileFind(tile, x, y, frequency);
+    if (found != NULL && cell != NULL) *cell = *found;
+    tileRelease(t, tile);
+    return found != NULL;
+}
+
+/**
+ * @struct CellSet
+ * @brief Conjunto de posições (x, y) já visitadas numa pesquisa sobre um TiledGraph.
+ * 
+ * Tabela de hash de endereçamento aberto: a memória cresce com as antenas visitadas
+ * e não com o tamanho da matriz.
+ */
+typedef struct CellSet{
+    uint64_t *keys; // (x << 32) | y, ou UINT64_MAX quando a posição está livre
+    size_t capacity; // Potência de 2
+    size_t count;
+} CellSet;
+
+/**
+ * @brief Acrescenta uma posição ao conjunto
+ * 
+ * @param set Pointer para o conjunto
+ * @param x Linha (não negativa)
+ * @param y Coluna (não negativa)
+ * @return int 1 se a posição foi acrescentada, 0 se já existia, -1 se faltou memória
+ */
+static int cellSetAdd(CellSet *set, int x, int y){
+    if ((set->count + 1) * 2 > set->capacity) {
+        size_t newCapacity = set->capacity > 0 ? set->capacity * 2 : 256;
+        uint64_t *keys = (uint64_t*)malloc(sizeof(uint64_t) * newCapacity);
+        if (keys == NULL) return -1;
+        memset(keys, 0xFF, sizeof(uint64_t) * newCapacity);
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (set->keys[i] == UINT64_MAX) continue;
+            size_t slot = (size_t)((set->keys[i] * 0x9E3779B97F4A7C15ULL) >> 17) & (newCapacity - 1);
+            while (keys[slot] != UINT64_MAX) slot = (slot + 1) & (newCapacity - 1);
+            keys[slot] = set->keys[i];
+        }
+        free(set->keys);
+        set->keys = keys;
+        set->capacity = newCapacity;
+    }
+    uint64_t key = (uint64_t)(uint32_t)x << 32 | (uint32_t)y;
+    size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17) & (set->capacity - 1);
+    while (set->keys[slot] != UINT64_MAX) {
+        if (set->keys[slot] == key) return 0;
+        slot = (slot + 1) & (set->capacity - 1);
+    }
+    set->keys[slot] = key;
+    set->count++;
+    return 1;
+}
+
+/**
+ * @struct CellBuffer
+ * @brief Array de antenas copiadas dos blocos (fila, pilha ou adjacentes de uma pesquisa).
+ * 
+ * Guarda cópias porque um bloco pode ser descarregado enquanto a pesquisa continua.
+ */
+typedef struct CellBuffer{
+    AntennaCell *cells;
+    int count;
+    int capacity;
+} CellBuffer;
+
+/** @brief Acrescenta uma antena ao fim do buffer; devolve false se faltou memória */
+static bool cellBufferPush(CellBuffer *b, const AntennaCell *cell){
+    if (b->count == b->capacity) {
+        int newCapacity = b->capacity > 0 ? b->capacity * 2 : 64;
+        AntennaCell *cells = (AntennaCell*)realloc(b->cells, sizeof(AntennaCell) * newCapacity);
+        if (cells == NULL) return false;
+        b->cells = cells;
+        b->capacity = newCapacity;
+    }
+    b->cells[b->count++] = *cell;
+    return true;
+}
+
+/**
+ * @brief Acrescenta a out os adjacentes de uma antena ainda não visitados
+ * 
+ * Com radius, só os blocos que intersetam o quadrado de lado 2·radius à volta da antena
+ * são lidos; sem radius os adjacentes são todos os membros da frequência, em todos os
+ * blocos que a têm.
+ * 
+ * @param t Pointer para o grafo em blocos
+ * @param cell Antena cujos adjacentes são procurados
+ * @param visited Posições já visitadas (os adjacentes encontrados são acrescentados)
+ * @param out Recebe os adjacentes, pela ordem dos blocos
+ * @return true se terminou, false se faltou memória ou um bloco não pôde ser lido
+ */
+static bool tiledNeighbors(TiledGraph *t, const AntennaCell *cell, CellSet *visited, CellBuffer *out){
+    const TiledHeader *h = &t->header;
+    int r = t->radius;
+    int firstRow = 0, lastRow = h->tileRows - 1, firstCol = 0, lastCol = h->tileCols - 1;
+    if (r > 0) {
+        firstRow = (cell->x - r > 0 ? cell->x - r : 0) / h->tileSize;
+        lastRow = (cell->x + r < h->rows ? cell->x + r : h->rows - 1) / h->tileSize;
+        firstCol = (cell->y - r > 0 ? cell->y - r : 0) / h->tileSize;
+        lastCol = (cell->y + r < h->cols ? cell->y + r : h->cols - 1) / h->tileSize;
+    }
+
+    for (int tr = firstRow; tr <= lastRow; tr++) {
+        for (int tc = firstCol; tc <= lastCol; tc++) {
+            int index = tr * h->tileCols + tc;
+            if (!tileHasFrequency(t, index, cell->frequency)) continue;
+            Tile *tile = tileAcquire(t, index);
+            if (tile == NULL) return false;
+            int i = r > 0 ? tileLowerRow(tile, cell->x - r) : 0;
+            bool ok = true;
+            for (; i < tile->count && ok; i++) {
+                const AntennaCell *c = &tile->cells[i];
+                if (r > 0 && c->x > cell->x + r) break;
+                if (c->frequency != cell->frequency) continue;
+                if (r > 0) {
+                    long long dx = (long long)c->x - cell->x;
+                    long long dy = (long long)c->y - cell->y;
+                    if (dx * dx + dy * dy > (long long)r * r) continue;
+                }
+                int added = cellSetAdd(visited, c->x, c->y);
+                if (added < 0 || (added > 0 && !cellBufferPush(out, c))) ok = false;
+            }
+            tileRelease(t, tile);
+            if (!ok) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Pesquisa sobre o grafo em blocos, em largura ou em profundidade
+ * 
+ * Em largura os vértices saem do início do buffer (fila); em profundidade saem do fim
+ * (pilha), com os adjacentes de cada vértice empilhados pela ordem inversa, para o
+ * primeiro adjacente ser visitado primeiro. Sem radius, os adjacentes da antena inicial
+ * já são todos os membros da frequência: só esses são procurados, pelo que cada bloco
+ * da frequência é lido uma vez por pesquisa.
+ * 
+ * @param t Pointer para o grafo em blocos
+ * @param startX Linha da antena inicial
+ * @param startY Coluna da antena inicial
+ * @param frequency Frequência da antena inicial
+ * @param depthFirst true para a pesquisa em profundidade
+ * @param visit Função chamada para cada antena visitada
+ * @param userData Pointer passado sem alterações ao visit
+ * @return true se a pesquisa terminou, false se a antena não existe, faltou memória ou
+ *         um bloco não pôde ser lido
+ */
+static bool tiledSearch(TiledGraph *t, int startX, int startY, char frequency, bool depthFirst,
+                        CellVisitor visit, void *userData){
+    AntennaCell start;
+    if (!tiledFindAntenna(t, startX, startY, frequency, &start)) return false;
 
-        // Escrever adjacentes (coordenadas)
-        adj = v->adjacents;
-        while (adj) {
-            int x = adj->vertex->x;
-            int y = adj->vertex->y;
-            fwrite(&x, sizeof(int), 1, f);
-            fwrite(&y, sizeof(int), 1, f);
-            adj = adj->next;
+    CellSet visited = { NULL, 0, 0 };
+    CellBuffer pending = { NULL, 0, 0 };
+    CellBuffer neighbors = { NULL, 0, 0 };
+    bool ok = cellSetAdd(&visited, start.x, start.y) > 0 && cellBufferPush(&pending, &start);
+    int head = 0;
+    bool enumerated = false; // Sem radius, os adjacentes da antena inicial já são toda a frequência
+    while (ok && head < pending.count) {
+        AntennaCell cell = depthFirst ? pending.cells[--pending.count] : pending.cells[head++];
+        if (visit != NULL) visit(&cell, userData);
+        if (enumerated) continue;
+
+        neighbors.count = 0;
+        ok = tiledNeighbors(t, &cell, &visited, &neighbors);
+        enumerated = t->radius == 0;
+        for (int i = 0; i < neighbors.count && ok; i++) {
+            int k = depthFirst ? neighbors.count - 1 - i : i;
+            ok = cellBufferPush(&pending, &neighbors.cells[k]);
         }
-        v = v->next;
     }
-
-    fclose(f);
+    free(visited.keys);
+    free(pending.cells);
+    free(neighbors.cells);
+    return ok;
 }
 
 /**
- * @brief Lê um grafo a partir de um ficheiro binário.
+ * @brief Visita em profundidade as antenas ligadas a uma antena do grafo em blocos
  * 
- * Esta função reconstrói um grafo previamente guardado em formato binário, criando os vértices
- * e estabelecendo as adjacências com base nas coordenadas guardadas.
+ * Os blocos são lidos à medida que a pesquisa chega a eles. Os adjacentes de cada antena
+ * são visitados pela ordem dos blocos, pelo que a ordem de visita pode ser diferente da
+ * do depthFirstSearch sobre um Graph, mas as antenas visitadas são as mesmas.
  * 
- * @param filename Nome do ficheiro binário de onde o grafo será lido.
- * @return Pointer para o grafo reconstruído. Retorna NULL em caso de erro na leitura.
+ * @param t Pointer para o grafo em blocos
+ * @param startX Linha da antena inicial
+ * @param startY Coluna da antena inicial
+ * @param frequency Frequência da antena inicial
+ * @param visit Função chamada para cada antena visitada (a antena só é válida durante a chamada)
+ * @param userData Pointer passado sem alterações ao visit
+ * @return true se a pesquisa terminou, false se a antena não existe, faltou memória ou
+ *         um bloco não pôde ser lido
  */
-Graph *readGraphFromBinary(const char *filename) {
-    FILE *f = fopen(filename, "rb");
-    if (!f) return NULL;
+bool tiledDepthFirstSearch(TiledGraph *t, int startX, int startY, char frequency, CellVisitor visit, void *userData){
+    INSTRUMENT_FUNCTION();
+    return tiledSearch(t, startX, startY, frequency, true, visit, userData);
+}
 
-    Graph *g = createGraph();
+/**
+ * @brief Visita em largura as antenas ligadas a uma antena do grafo em blocos
+ * 
+ * Ver tiledDepthFirstSearch; as antenas são visitadas por ordem de distância (em ligações)
+ * à antena inicial.
+ * 
+ * @param t Pointer para o grafo em blocos
+ * @param startX Linha da antena inicial
+ * @param startY Coluna da antena inicial
+ * @param frequency Frequência da antena inicial
+ * @param visit Função chamada para cada antena visitada (a antena só é válida durante a chamada)
+ * @param userData Pointer passado sem alterações ao visit
+ * @return true se a pesquisa terminou, false se a antena não existe, faltou memória ou
+ *         um bloco não pôde ser lido
+ */
+bool tiledBreadthFirstSearch(TiledGraph *t, int startX, int startY, char frequency, CellVisitor visit, void *userData){
+    INSTRUMENT_FUNCTION();
+    return tiledSearch(t, startX, startY, frequency, false, visit, userData);
+}
 
-    int vertexCount;
-    fread(&vertexCount, sizeof(int), 1, f);
+/**
+ * @brief Encontra os pares de antenas vizinhas com frequências A e B no grafo em blocos
+ * 
+ * Percorre só os blocos com antenas da frequência A e, para cada uma, procura uma antena
+ * da frequência B nas 8 posições à volta, lendo o bloco vizinho quando a posição fica
+ * do outro lado da fronteira. Os pares são os mesmos do listIntersectionsVisit.
+ * 
+ * @param t Pointer para o grafo em blocos
+ * @param frequencyA Frequência das antenas A
+ * @param frequencyB Frequência das antenas B
+ * @param sink Função chamada para cada par (antena A, antena B)
+ * @param userData Pointer passado sem alterações ao sink
+ * @return long long Número de pares encontrados, ou -1 se um bloco não pôde ser lido
+ */
+long long tiledListIntersections(TiledGraph *t, char frequencyA, char frequencyB, CellPairSink sink, void *userData){
+    INSTRUMENT_FUNCTION();
+    if (t == NULL) return 0;
+    static const int dx[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    static const int dy[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    int tileCount = t->header.tileRows * t->header.tileCols;
+    long long found = 0;
 
-    // Criar todos os vértices e inserir no grafo
-    for (int i = 0; i < vertexCount; i++) {
-        int x, y;
-        char freq;
-        fread(&x, sizeof(int), 1, f);
-        fread(&y, sizeof(int), 1, f);
-        fread(&freq, sizeof(char), 1, f);
-        addVertex(g, x, y, freq);  // adiciona já ao grafo
+    for (int index = 0; index < tileCount; index++) {
+        if (!tileHasFrequency(t, index, frequencyA)) continue;
+        Tile *tile = tileAcquire(t, index);
+        if (tile == NULL) return -1;
+        for (int i = 0; i < tile->count; i++) {
+            const AntennaCell *a = &tile->cells[i];
+            if (a->frequency != frequencyA) continue;
+            for (int d = 0; d < 8; d++) {
+                int nx = a->x + dx[d], ny = a->y + dy[d];
+                int other = tileIndexOf(t, nx, ny);
+                if (other < 0 || !tileHasFrequency(t, other, frequencyB)) continue;
+                Tile *neighborTile = other == index ? tile : tileAcquire(t, other);
+                if (neighborTile == NULL) {
+                    tileRelease(t, tile);
+                    return -1;
+                }
+                const AntennaCell *b = tileFind(neighborTile, nx, ny, frequencyB);
+                if (b != NULL) {
+                    if (sink != NULL) sink(a, b, userData);
+                    found++;
+                }
+                if (neighborTile != tile) tileRelease(t, neighborTile);
+            }
+        }
+        tileRelease(t, tile);
     }
+    return found;
+}
 
-    // Agora ler as adjacências e ligar os vértices
-    for (int i = 0; i < vertexCount; i++) {
-        int adjCount;
-        fread(&adjCount, sizeof(int), 1, f);
+/**
+ * @brief Fecha um grafo em blocos e liberta os blocos carregados
+ * 
+ * @param t Pointer para o grafo em blocos (pode ser NULL)
+ */
+void closeTiledGraph(TiledGraph *t){
+    if (t == NULL) return;
+    Tile *tile = t->newest;
+    while (tile != NULL) {
+        Tile *older = tile->older;
+        free(tile->cells);
+        free(tile);
+        tile = older;
+    }
+    close(t->fd);
+    free(t->directory);
+    free(t->tiles);
+    free(t);
+}
 
-        // Pega o vértice que está na posicao i da lista (simplesmente percorrer)
-        Vertex *v = g->vertices;
-        for (int j = 0; j < i - 1; j++) {
-            v = v->next;
+/** @brief Guarda no resultado (QueryResult) um caminho encontrado */
+static bool collectPath(Vertex **path, int length, void *userData){
+    QueryResult *r = (QueryResult*)userData;
+    if (r->failed) return false;
+    if (r->pathCount == r->pathCapacity) {
+        int newCapacity = r->pathCapacity > 0 ? r->pathCapacity * 2 : 16;
+        int *lengths = (int*)realloc(r->pathLengths, sizeof(int) * newCapacity);
+        if (lengths == NULL) {
+            r->failed = true;
+            return false;
         }
+        r->pathLengths = lengths;
+        r->pathCapacity = newCapacity;
+    }
+    r->pathLengths[r->pathCount++] = length;
+    for (int i = 0; i < length; i++) {
+        resultAddVertex(r, path[i]);
+    }
+    return !r->failed;
+}
 
-        for (int k = 0; k < adjCount; k++) {
-            int x_adj, y_adj;
-            fread(&x_adj, sizeof(int), 1, f);
-            fread(&y_adj, sizeof(int), 1, f);
+/**
+ * @struct IntersectionCollector
+ * @brief Estado do sink que guarda as intersecções de uma consulta.
+ */
+typedef struct IntersectionCollector{
+    QueryResult *result;
+    char frequencyA; // Frequência que fica em primeiro lugar em cada par
+} IntersectionCollector;
 
-            // Encontrar o vértice adjacente pela coordenada
-            Vertex *adjV = g->vertices;
-            while (adjV != NULL) {
-                if (adjV->x == x_adj && adjV->y == y_adj) break;
-                adjV = adjV->next;
-            }
-        }
+/** @brief Guarda no resultado um par de antenas, com a frequência A em primeiro lugar */
+static void collectIntersection(Vertex *a, Vertex *b, void *userData){
+    IntersectionCollector *c = (IntersectionCollector*)userData;
+    if (a->frequency != c->frequencyA) {
+        Vertex *t = a;
+        a = b;
+        b = t;
     }
-
-    fclose(f);
-    return g;
+    resultAddVertex(c->result, a);
+    resultAddVertex(c->result, b);
+    c->result->pathCount++;
 }
 
 /**
- * @brief Visita recursiva para Depth-First Search (DFS)
- * 
- * Esta função marca o vértice como visitado, imprime-o, e recursivamente visita os seus adjacentes
- * que tenham a mesma frequência e ainda não tenham sido visitados.
- * 
- * DFS em output: visita sempre o primeiro adjacente de cada vértice
+ * @brief Executa uma consulta do lote e guarda o resultado
  * 
- * @param v Pointer para o vértice atual
+ * @param g Pointer para o grafo
+ * @param ctx Contexto de pesquisa da thread que executa a consulta
+ * @param q Consulta a executar
+ * @param r Resultado a preencher
  */
-void dfsVisit(Vertex* v) {
-    if (v == NULL || v->visited)
+static void runQuery(Graph *g, TraversalContext *ctx, const Query *q, QueryResult *r){
+    memset(r, 0, sizeof(QueryResult));
+
+    if (q->kind == QUERY_INTERSECTIONS) {
+        r->found = true;
+        // Só percorre os membros das duas frequências, com a mesma semântica do writeIntersections
+        IntersectionCollector c = { r, q->frequency };
+        listIntersectionsVisit(g, q->frequency, q->frequencyB, collectIntersection, &c);
         return;
+    }
 
-    v->visited = true;
-    printf("Visited: (%d, %d)\n", v->x, v->y);
+    Vertex *start = findVertex(g, q->x1, q->y1, q->frequency);
+    if (start == NULL) return;
 
-    AdjList* adj = v->adjacents;
-    while (adj != NULL) {
-        Vertex* neighbor = adj->vertex;
-        if (!neighbor->visited && neighbor->frequency == v->frequency) {
-            dfsVisit(neighbor);
+    bool ok = true;
+    if (q->kind == QUERY_DFS) {
+        r->found = true;
+        ok = dfsFrom(g, ctx, start, collectVisited, r);
+    } else if (q->kind == QUERY_BFS) {
+        r->found = true;
+        ok = bfsFrom(g, ctx, start, collectVisited, r);
+    } else if (q->kind == QUERY_PATHS) {
+        Vertex *destination = findVertex(g, q->x2, q->y2, q->frequency);
+        if (destination == NULL) return;
+        r->found = true;
+        ok = pathsBetween(g, ctx, start, destination, q->maxLength, q->maxResults, collectPath, r) >= 0;
+    } else if (q->kind == QUERY_REACHABLE) {
+        Vertex *destination = findVertex(g, q->x2, q->y2, q->frequency);
+        if (destination == NULL) return;
+        r->found = true;
+        r->reachable = sameComponent(g, start, destination);
+    } else if (q->kind == QUERY_SHORTEST_PATH) {
+        Vertex *destination = findVertex(g, q->x2, q->y2, q->frequency);
+        if (destination == NULL) return;
+        r->found = true;
+        double cost;
+        int length = routeBetween(g, ctx, start, destination, false, &cost);
+        ok = length >= 0;
+        if (length > 0) r->reachable = collectPath(ctx->path, length, r);
+    }
+    if (!ok) r->failed = true;
+}
+
+/**
+ * @struct QueryBatch
+ * @brief Estado partilhado pelas threads de um lote de consultas.
+ */
+typedef struct QueryBatch{
+    Graph *g;
+    const Query *queries;
+    QueryResult *results;
+    int count;
+    int next; // Próxima consulta por atribuir (incrementada atomicamente)
+} QueryBatch;
+
+/**
+ * @brief Ciclo de uma thread do lote: retira consultas até não haver mais
+ * 
+ * Cada thread tem o seu próprio contexto de pesquisa, pelo que nenhuma consulta
+ * altera o grafo nem o estado de outra thread.
+ * 
+ * @param arg Pointer para o QueryBatch
+ * @return void* NULL
+ */
+static void *queryWorker(void *arg){
+    QueryBatch *batch = (QueryBatch*)arg;
+    TraversalContext *ctx = createTraversalContext();
+
+    int i;
+    while ((i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->count) {
+        if (ctx == NULL) {
+            memset(&batch->results[i], 0, sizeof(QueryResult));
+            batch->results[i].failed = true;
+            continue;
         }
-        adj = adj->next;
+        runQuery(batch->g, ctx, &batch->queries[i], &batch->results[i]);
     }
+
+    freeTraversalContext(ctx);
+    return NULL;
 }
 
 /**
- * @brief Função principal que inicia a Depth-First Search (DFS) no grafo
+ * @brief Executa um lote de consultas (DFS, BFS, caminhos e intersecções) em várias threads
  * 
- * Procura o vértice inicial com as coordenadas e frequência dadas,
- * reseta o estado visited de todos os vértices,
- * e inicia a visita recursiva a partir do vértice inicial.
- *
+ * As consultas são distribuídas dinamicamente por um conjunto de threads que partilham o
+ * mesmo grafo, sem o alterar. O resultado de queries[i] fica em results[i], pelo que os
+ * resultados saem pela ordem das consultas. O grafo não pode ser alterado durante o lote.
  * 
  * @param g Pointer para o grafo
- * @param startX Coordenada x do vértice inicial
- * @param startY Coordenada y do vértice inicial
- * @param freq Frequência do vértice inicial
+ * @param queries Array de consultas
+ * @param results Array com count posições onde ficam os resultados
+ * @param count Número de consultas
+ * @param threadCount Número de threads, ou 0 para usar todos os processadores
  */
-void depthFirstSearch(Graph* g, int startX, int startY, char frequency) {
-    Vertex* start = g->vertices;
+void runQueryBatch(Graph *g, const Query *queries, QueryResult *results, int count, int threadCount){
+    INSTRUMENT_FUNCTION();
+    if (g == NULL || count <= 0) return;
 
-    // Encontrar o vértice inicial
-    while (start != NULL) {
-        if (start->x == startX && start->y == startY && start->frequency == frequency)
-            break;
-        start = start->next;
+    if (threadCount <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = cpus > 0 ? (int)cpus : 1;
     }
+    if (threadCount > count) threadCount = count;
 
-    if (start == NULL) {
-        return;
-    }
+    QueryBatch batch = { g, queries, results, count, 0 };
 
-    // Reset aos visitados
-    Vertex* v = g->vertices;
-    while (v != NULL) {
-        v->visited = false;  // Reset ao campo visited
-        v = v->next;
+    // A thread atual também trabalha, por isso só são criadas threadCount - 1
+    pthread_t *threads = (pthread_t*)malloc(sizeof(pthread_t) * threadCount);
+    int started = 0;
+    for (int i = 1; i < threadCount && threads != NULL; i++) {
+        if (pthread_create(&threads[started], NULL, queryWorker, &batch) != 0) break;
+        started++;
     }
-
-    dfsVisit(start);
+    queryWorker(&batch);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
 }
 
 /**
- * @brief Implementa a Breadth-First Search (BFS) no grafo
+ * @brief Liberta a memória dos resultados de um lote de consultas
  * 
- * Procura o vértice inicial com as coordenadas e frequência dadas, reseta o estado visited de todos os vértices,
- * e usa uma estrutura em fila para visitar todos os vértices alcançáveis ligados a partir do vértice inicial, com a mesma frequência.
+ * O array results pertence a quem chamou o runQueryBatch e não é libertado.
  * 
- * BFS em output: visita todos os adjacentes diretos primeiro
+ * @param results Array de resultados
+ * @param count Número de resultados
+ */
+void freeQueryResults(QueryResult *results, int count){
+    INSTRUMENT_FUNCTION();
+    if (results == NULL) return;
+    for (int i = 0; i < count; i++) {
+        free(results[i].vertices);
+        free(results[i].pathLengths);
+        results[i].vertices = NULL;
+        results[i].pathLengths = NULL;
+        results[i].vertexCount = results[i].vertexCapacity = 0;
+        results[i].pathCount = results[i].pathCapacity = 0;
+    }
+}
+
+/** Número inicial de baldes da tabela de hash do QueryCache */
+#define QUERY_CACHE_MIN_BUCKETS 64
+
+/**
+ * @brief Cria uma cache de resultados de consultas sobre um grafo
  * 
  * @param g Pointer para o grafo
- * @param startX Coordenada x do vértice inicial
- * @param startY Coordenada y do vértice inicial
- * @param freq Frequência do vértice inicial
+ * @param capacity Número máximo de resultados guardados
+ * @return QueryCache* Pointer para a cache, ou NULL se capacity não é positivo ou faltou memória
  */
-void breadthFirstSearch(Graph* g, int startX, int startY, char frequency) {
-    Vertex* start = g->vertices;
+QueryCache *createQueryCache(Graph *g, int capacity){
+    INSTRUMENT_FUNCTION();
+    if (g == NULL || capacity <= 0) return NULL;
+    QueryCache *cache = (QueryCache*)calloc(1, sizeof(QueryCache));
+    if (cache == NULL) return NULL;
 
-    // Encontrar o vértice inicial
-    while (start != NULL) {
-        if (start->x == startX && start->y == startY && start->frequency == frequency)
-            break;
-        start = start->next;
+    // Uma entrada por balde, em média, com a cache cheia
+    int bucketCount = QUERY_CACHE_MIN_BUCKETS;
+    while (bucketCount < capacity && bucketCount < (1 << 30)) bucketCount <<= 1;
+    cache->buckets = (QueryCacheEntry**)calloc(bucketCount, sizeof(QueryCacheEntry*));
+    cache->ctx = createTraversalContext();
+    if (cache->buckets == NULL || cache->ctx == NULL) {
+        free(cache->buckets);
+        freeTraversalContext(cache->ctx);
+        free(cache);
+        return NULL;
     }
+    instrumentAllocation(sizeof(QueryCache) + sizeof(QueryCacheEntry*) * bucketCount);
+    cache->g = g;
+    cache->version = g->version;
+    cache->bucketCount = bucketCount;
+    cache->capacity = capacity;
+    return cache;
+}
 
-    if (start == NULL) {
+/**
+ * @brief Copia de uma consulta só os campos usados pelo seu tipo
+ * 
+ * Duas consultas com o mesmo resultado ficam com a mesma chave, e os campos ignorados
+ * e o enchimento da estrutura ficam a 0, para a chave poder ser comparada com memcmp.
+ * 
+ * @param q Consulta
+ * @param key Chave a preencher
+ */
+static void queryKey(const Query *q, Query *key){
+    memset(key, 0, sizeof(Query));
+    key->kind = q->kind;
+    key->frequency = q->frequency;
+    if (q->kind == QUERY_INTERSECTIONS) {
+        key->frequencyB = q->frequencyB;
         return;
     }
+    key->x1 = q->x1;
+    key->y1 = q->y1;
+    if (q->kind == QUERY_DFS || q->kind == QUERY_BFS) return;
+    key->x2 = q->x2;
+    key->y2 = q->y2;
+    if (q->kind == QUERY_PATHS) {
+        key->maxLength = q->maxLength;
+        key->maxResults = q->maxResults;
+    }
+}
 
-    // Resetar todos os vértices para "não visitados" 
-    Vertex* v = g->vertices;
-    while (v != NULL) {
-        v->visited = false;
-        v = v->next;
+/** @brief Hash FNV-1a dos bytes de uma chave criada pelo queryKey */
+static unsigned int queryHash(const Query *key){
+    const unsigned char *bytes = (const unsigned char*)key;
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(Query); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
     }
+    return hash;
+}
 
-    // Estrutura em fila para BFS (array de Pointers para vértices)
-    Vertex* queue[100];
-    int front = 0, back = 0;
+/** @brief Retira uma entrada da lista LRU da cache */
+static void cacheUnlink(QueryCache *cache, QueryCacheEntry *e){
+    if (e->newer != NULL) e->newer->older = e->older; else cache->newest = e->older;
+    if (e->older != NULL) e->older->newer = e->newer; else cache->oldest = e->newer;
+    e->newer = e->older = NULL;
+}
 
-    // Iniciar com o vértice inicial
-    queue[back] = start;
-    back++;
-    start->visited = true;
+/** @brief Coloca uma entrada no início da lista LRU da cache */
+static void cachePushNewest(QueryCache *cache, QueryCacheEntry *e){
+    e->newer = NULL;
+    e->older = cache->newest;
+    if (cache->newest != NULL) cache->newest->newer = e; else cache->oldest = e;
+    cache->newest = e;
+}
 
-    while (front < back) {
-        //dequeue
-        Vertex* current = queue[front++];
-        printf("Visited: (%d, %d)\n", current->x, current->y);
-
-        AdjList* adj = current->adjacents;
-        while (adj != NULL) {
-            Vertex* neighbor = adj->vertex;
-            if (!neighbor->visited && neighbor->frequency == current->frequency) {
-                neighbor->visited = true;
-                //enqueue
-                queue[back++] = neighbor;
+/** @brief Retira uma entrada da cache (tabela de hash e lista LRU) e liberta-a */
+static void cacheRemove(QueryCache *cache, QueryCacheEntry *e){
+    QueryCacheEntry **link = &cache->buckets[e->hash & (cache->bucketCount - 1)];
+    while (*link != e) link = &(*link)->chain;
+    *link = e->chain;
+    cacheUnlink(cache, e);
+    freeQueryResults(&e->result, 1);
+    free(e);
+    cache->count--;
+}
+
+/**
+ * @brief Devolve o resultado de uma consulta, guardado ou calculado agora
+ * 
+ * Se o grafo mudou desde que os resultados foram guardados (a versão do grafo é outra),
+ * todos são descartados primeiro. Um resultado calculado agora é guardado, descartando
+ * o usado há mais tempo se a cache estiver cheia; um resultado em que faltou memória
+ * (failed) não é guardado. Não é seguro usar a mesma cache em várias threads ao mesmo tempo.
+ * 
+ * @param cache Pointer para a cache
+ * @param q Consulta, como no runQueryBatch
+ * @return const QueryResult* Resultado, válido até à próxima chamada sobre a cache ou
+ *         alteração do grafo, ou NULL se a cache é NULL
+ */
+const QueryResult *cachedQuery(QueryCache *cache, const Query *q){
+    INSTRUMENT_FUNCTION();
+    if (cache == NULL || q == NULL) return NULL;
+    freeQueryResults(&cache->uncached, 1);
+    if (cache->version != cache->g->version) {
+        if (cache->count > 0) cache->invalidations++;
+        clearQueryCache(cache);
+        cache->version = cache->g->version;
+    }
+
+    Query key;
+    queryKey(q, &key);
+    unsigned int hash = queryHash(&key);
+    QueryCacheEntry **bucket = &cache->buckets[hash & (cache->bucketCount - 1)];
+    for (QueryCacheEntry *e = *bucket; e != NULL; e = e->chain) {
+        if (e->hash == hash && memcmp(&e->key, &key, sizeof(Query)) == 0) {
+            cache->hits++;
+            if (e != cache->newest) {
+                cacheUnlink(cache, e);
+                cachePushNewest(cache, e);
             }
-            adj = adj->next;
+            return &e->result;
         }
     }
+
+    cache->misses++;
+    QueryCacheEntry *e = (QueryCacheEntry*)calloc(1, sizeof(QueryCacheEntry));
+    QueryResult *r = e != NULL ? &e->result : &cache->uncached;
+    runQuery(cache->g, cache->ctx, &key, r);
+    if (e == NULL) {
+        r->failed = true;
+        return r;
+    }
+    if (r->failed) {
+        cache->uncached = *r;
+        free(e);
+        return &cache->uncached;
+    }
+
+    if (cache->count == cache->capacity) {
+        cacheRemove(cache, cache->oldest);
+        cache->evictions++;
+    }
+    e->key = key;
+    e->hash = hash;
+    e->chain = *bucket;
+    *bucket = e;
+    cachePushNewest(cache, e);
+    cache->count++;
+    instrumentAllocation(sizeof(QueryCacheEntry)
+                         + sizeof(Vertex*) * (size_t)r->vertexCapacity + sizeof(int) * (size_t)r->pathCapacity);
+    return r;
 }
 
 /**
- * @brief Função recursiva para encontrar todos os caminhos entre dois vértices com a mesma frequência
- *
- * Esta função explora recursivamente os vértices adjacentes do vértice atual, 
- * construindo um caminho temporário e imprimindo-o sempre que o vértice destino for alcançado.
- *
- * @param current Vértice atual na pesquisa
- * @param target Vértice destino que se pretende alcançar
- * @param path Array de pointers para os vértices que compõem o caminho atual
- * @param length Length controla o tamanho do caminho atual (ou seja, quantos vértices estão em path[])
+ * @brief Descarta todos os resultados guardados numa cache
+ * 
+ * @param cache Pointer para a cache
  */
-void findPathsRecursive(Vertex* current, Vertex* target, Vertex* path[], int length) {
-    if (current == NULL || current->visited)
-        return;
+void clearQueryCache(QueryCache *cache){
+    if (cache == NULL) return;
+    while (cache->oldest != NULL) {
+        cacheRemove(cache, cache->oldest);
+    }
+}
 
-    // Marca o vértice atual como visitado para evitar ciclos
-    current->visited = true;
-    // Adiciona o vértice atual ao caminho na posição length e incrementa o array
-    path[length] = current;
-    length++;
+/**
+ * @brief Liberta uma cache e os resultados guardados
+ * 
+ * @param cache Pointer para a cache (pode ser NULL)
+ */
+void freeQueryCache(QueryCache *cache){
+    if (cache == NULL) return;
+    clearQueryCache(cache);
+    freeQueryResults(&cache->uncached, 1);
+    freeTraversalContext(cache->ctx);
+    free(cache->buckets);
+    free(cache);
+}
 
-    // Se chegou ao destino imprime o caminho
-    if (current == target) {
-        printf("Path Founded: ");
-        for (int i = 0; i < length; i++) {
-            printf("(%d,%d)", path[i]->x, path[i]->y);
-            if (i < length - 1) printf(" -> ");
-        }
-        printf("\n");
-    // Se não chegou ao destino, explora os vértices adjacentes válidos para continuar a procura
-    } else {
-        AdjList* adj = current->adjacents;
-        while (adj != NULL) {
-            Vertex* neighbor = adj->vertex;
-            // Só visita o adjacente se ainda não foi visitado e tiver a mesma frequência que o atual
-            if (!neighbor->visited && neighbor->frequency == current->frequency) {
-                findPathsRecursive(neighbor, target, path, length);
-            }
-            adj = adj->next;
+/**
+ * @brief Cria um escritor com buffer para os resultados das pesquisas
+ * 
+ * @param file Ficheiro de destino (por exemplo stdout)
+ * @param format Formato dos resultados (texto ou CSV)
+ * @return OutputWriter* Pointer para o escritor, ou NULL se a memória falhar
+ */
+OutputWriter *createOutputWriter(FILE *file, OutputFormat format){
+    if (file == NULL) return NULL;
+    OutputWriter *w = malloc(sizeof(OutputWriter));
+    if (w == NULL) return NULL;
+    w->file = file;
+    w->format = format;
+    w->length = 0;
+    w->failed = false;
+    w->lineOpen = false;
+    w->pathIndex = 0;
+    return w;
+}
+
+/**
+ * @brief Envia para o ficheiro o conteúdo do buffer
+ * 
+ * @param w Pointer para o escritor
+ * @return true se todas as escritas até agora tiveram sucesso
+ */
+bool flushOutputWriter(OutputWriter *w){
+    INSTRUMENT_FUNCTION();
+    if (w == NULL) return false;
+    if (w->length > 0) {
+        if (fwrite(w->buffer, 1, w->length, w->file) != w->length) w->failed = true;
+        instrumentCount(INSTRUMENT_BYTES_WRITTEN, w->length);
+        w->length = 0;
+    }
+    if (fflush(w->file) != 0) w->failed = true;
+    return !w->failed;
+}
+
+/**
+ * @brief Faz flush e liberta o escritor (o ficheiro não é fechado)
+ * 
+ * @param w Pointer para o escritor
+ * @return true se todas as escritas tiveram sucesso
+ */
+bool freeOutputWriter(OutputWriter *w){
+    if (w == NULL) return false;
+    bool ok = flushOutputWriter(w);
+    free(w);
+    return ok;
+}
+
+/** @brief Copia bytes para o buffer, esvaziando-o para o ficheiro quando enche */
+static void writerPut(OutputWriter *w, const char *data, size_t size) {
+    while (size > 0) {
+        if (w->length == OUTPUT_BUFFER_SIZE) {
+            if (fwrite(w->buffer, 1, w->length, w->file) != w->length) w->failed = true;
+            instrumentCount(INSTRUMENT_BYTES_WRITTEN, w->length);
+            w->length = 0;
         }
+        size_t room = OUTPUT_BUFFER_SIZE - w->length;
+        size_t chunk = size < room ? size : room;
+        memcpy(w->buffer + w->length, data, chunk);
+        w->length += chunk;
+        data += chunk;
+        size -= chunk;
     }
+}
+
+/** @brief Escreve um carácter no buffer */
+static void writerChar(OutputWriter *w, char c) {
+    if (w->length == OUTPUT_BUFFER_SIZE) writerPut(w, &c, 1);
+    else w->buffer[w->length++] = c;
+}
+
+/** @brief Escreve um inteiro em decimal no buffer, sem printf */
+static void writerInt(OutputWriter *w, int value) {
+    char digits[12];
+    int n = sizeof(digits);
+    // Trabalhar com o valor absoluto em unsigned para suportar INT_MIN
+    unsigned int u = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do {
+        digits[--n] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    if (value < 0) digits[--n] = '-';
+    writerPut(w, digits + n, sizeof(digits) - n);
+}
+
+/** @brief Escreve um texto terminado em '\0' no buffer */
+static void writerString(OutputWriter *w, const char *text) {
+    writerPut(w, text, strlen(text));
+}
 
-    current->visited = false; 
+/** @brief Escreve uma frequência como campo CSV, entre aspas quando é um carácter especial */
+static void writerCsvFrequency(OutputWriter *w, char frequency) {
+    if (frequency == ',' || frequency == '"' || frequency == '\n' || frequency == '\r') {
+        writerChar(w, '"');
+        if (frequency == '"') writerChar(w, '"');
+        writerChar(w, frequency);
+        writerChar(w, '"');
+    } else {
+        writerChar(w, frequency);
+    }
 }
 
 /**
- * @brief Encontra e imprime todos os caminhos entre dois vértices com frequência comum.
- *
- * Procura os vértices de origem e destino no grafo com as coordenadas e frequência indicadas.
- * Se ambos forem encontrados, inicia a pesquisa para listar todos os caminhos possíveis entre eles.
- *
- * @param g Pointer para o grafo
- * @param x1 Coordenada X do vértice de origem
- * @param y1 Coordenada Y do vértice de origem
- * @param x2 Coordenada X do vértice de destino
- * @param y2 Coordenada Y do vértice de destino
- * @param frequency Frequência comum requerida para os vértices do caminho
+ * @brief Escreve texto livre (títulos, linhas em branco) no escritor
+ * 
+ * @param w Pointer para o escritor
+ * @param text Texto a escrever, sem alterações
  */
-void findAllPaths(Graph* g, int x1, int y1, int x2, int y2, char frequency) {
-    Vertex* origin = NULL;
-    Vertex* destination = NULL;
-    Vertex* v = g->vertices;
+void writeText(OutputWriter *w, const char *text){
+    if (w == NULL || text == NULL) return;
+    writerString(w, text);
+}
 
-    // Localizar os vértices de origem e destino
-    while (v != NULL) {
-        if (v->x == x1 && v->y == y1 && v->frequency == frequency)
-            origin = v;
-        if (v->x == x2 && v->y == y2 && v->frequency == frequency)
-            destination = v;
-        v->visited = false; // resetar visited
-        v = v->next;
+/** @brief Termina a linha do vértice anterior no texto do grafo */
+static void writerCloseLine(OutputWriter *w) {
+    if (w->lineOpen) {
+        writerChar(w, '\n');
+        w->lineOpen = false;
     }
+}
+
+/** @brief Escreve o início da linha de um vértice do grafo */
+static void writeGraphVertex(Vertex *v, void *userData) {
+    OutputWriter *w = userData;
+    if (w->format == OUTPUT_CSV) return;
+    writerCloseLine(w);
+    writerString(w, "Antenna (");
+    writerInt(w, v->x);
+    writerString(w, ", ");
+    writerInt(w, v->y);
+    writerString(w, ") [");
+    writerChar(w, v->frequency);
+    writerString(w, "] -> ");
+    w->lineOpen = true;
+}
 
-    if (!origin || !destination) {
+/** @brief Escreve uma ligação do grafo */
+static void writeGraphEdge(Vertex *from, Vertex *to, void *userData) {
+    OutputWriter *w = userData;
+    if (w->format == OUTPUT_CSV) {
+        writerInt(w, from->x);
+        writerChar(w, ',');
+        writerInt(w, from->y);
+        writerChar(w, ',');
+        writerCsvFrequency(w, from->frequency);
+        writerChar(w, ',');
+        writerInt(w, to->x);
+        writerChar(w, ',');
+        writerInt(w, to->y);
+        writerChar(w, '\n');
         return;
     }
+    writerChar(w, '(');
+    writerInt(w, to->x);
+    writerString(w, ", ");
+    writerInt(w, to->y);
+    writerString(w, ") ");
+}
+
+/**
+ * @brief Escreve o conteúdo do grafo
+ * 
+ * Em texto, escreve uma linha por vértice com os seus adjacentes, tal como o printGraph.
+ * Em CSV, escreve uma linha por ligação (x,y,frequency,adjacentX,adjacentY).
+ * 
+ * @param w Pointer para o escritor
+ * @param g Pointer para grafo
+ */
+void writeGraph(OutputWriter *w, Graph *g){
+    INSTRUMENT_FUNCTION();
+    if (w == NULL || g == NULL) return;
+    if (w->format == OUTPUT_CSV) writerString(w, "x,y,frequency,adjacentX,adjacentY\n");
+    w->lineOpen = false;
+    visitGraph(g, writeGraphVertex, writeGraphEdge, w);
+    writerCloseLine(w);
+}
 
-    // Array temporário para guardar o caminho atual (tamanho máximo: nº de vértices)
-    Vertex* path[100];
-    findPathsRecursive(origin, destination, path, 0);
+/** @brief Escreve um vértice visitado pelo DFS ou BFS */
+static void writeVisited(Vertex *v, void *userData) {
+    OutputWriter *w = userData;
+    if (w->format == OUTPUT_CSV) {
+        writerInt(w, v->x);
+        writerChar(w, ',');
+        writerInt(w, v->y);
+        writerChar(w, ',');
+        writerCsvFrequency(w, v->frequency);
+        writerChar(w, '\n');
+        return;
+    }
+    writerString(w, "Visited: (");
+    writerInt(w, v->x);
+    writerString(w, ", ");
+    writerInt(w, v->y);
+    writerString(w, ")\n");
 }
 
 /**
- * @brief Verifica e lista de pares de vértices com frequência A e B que são vizinhos, considerando todas as direções adjacentes (4 sentidos diretos e 4 sentidos diagonais).
+ * @brief Escreve os vértices visitados por um Depth-First Search (DFS)
  * 
- * A função percorre todos os vértices do grafo que possuam vizinhos com uma frequencia distinta, 
- * nos 8 sentidos possíveis da função.
+ * @param w Pointer para o escritor
+ * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ * @return true se a pesquisa foi feita, false se o vértice não existe ou faltou memória
+ */
+bool writeDepthFirstSearch(OutputWriter *w, Graph *g, TraversalContext *ctx, int startX, int startY, char frequency){
+    INSTRUMENT_FUNCTION();
+    if (w == NULL) return false;
+    if (w->format == OUTPUT_CSV) writerString(w, "x,y,frequency\n");
+    return depthFirstSearchVisit(g, ctx, startX, startY, frequency, writeVisited, w);
+}
+
+/**
+ * @brief Escreve os vértices visitados por um Breadth-First Search (BFS)
  * 
+ * @param w Pointer para o escritor
  * @param g Pointer para o grafo
- * @param frequencyA Frequências dos vértices A
- * @param frequencyB Frequências dos vértices A
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param startX Coordenada x do vértice inicial
+ * @param startY Coordenada y do vértice inicial
+ * @param frequency Frequência do vértice inicial
+ * @return true se a pesquisa foi feita, false se o vértice não existe ou faltou memória
  */
-void listIntersectionsBetweenFrequencies(Graph *g, char frequencyA, char frequencyB) {
-    Vertex *vA = g->vertices;
-    while (vA != NULL) {
-        if (vA->frequency == frequencyA) {
-            Vertex *vB = g->vertices;
-            while (vB != NULL) {
-                if (vB->frequency == frequencyB) {
-                    // Vizinhos sentido direto
-                    int topNeighbor = (vA->x == vB->x && vA->y == vB->y + 1);
-                    int bottomNeighbor = (vA->x == vB->x && vA->y == vB->y - 1);
-                    int leftNeighbor = (vA->x == vB->x + 1 && vA->y == vB->y);
-                    int rightNeighbor = (vA->x == vB->x - 1 && vA->y == vB->y);
-
-                    // Vizinhos sentido diagonal
-                    int topLeftNeighbor = (vA->x == vB->x + 1 && vA->y == vB->y + 1);
-                    int topRightNeighbor = (vA->x == vB->x - 1 && vA->y == vB->y + 1);
-                    int bottomLeftNeighbor = (vA->x == vB->x + 1 && vA->y == vB->y - 1);
-                    int bottomRightNeighbor = (vA->x == vB->x - 1 && vA->y == vB->y - 1);
-
-                    if (topNeighbor || bottomNeighbor || leftNeighbor || rightNeighbor ||
-                        topLeftNeighbor || topRightNeighbor || bottomLeftNeighbor || bottomRightNeighbor) {
-                        printf("Intersection between (%d, %d) [%c] and (%d, %d) [%c]\n",
-                               vA->x, vA->y, vA->frequency,
-                               vB->x, vB->y, vB->frequency);
-                    }
-                }
-                vB = vB->next;
-            }
+bool writeBreadthFirstSearch(OutputWriter *w, Graph *g, TraversalContext *ctx, int startX, int startY, char frequency){
+    INSTRUMENT_FUNCTION();
+    if (w == NULL) return false;
+    if (w->format == OUTPUT_CSV) writerString(w, "x,y,frequency\n");
+    return breadthFirstSearchVisit(g, ctx, startX, startY, frequency, writeVisited, w);
+}
+
+/** @brief Escreve um caminho encontrado pelo findPathsBounded */
+static bool writePath(Vertex **path, int length, void *userData) {
+    OutputWriter *w = userData;
+    if (w->format == OUTPUT_CSV) {
+        // Uma linha por passo do caminho
+        for (int i = 0; i < length; i++) {
+            writerInt(w, (int)w->pathIndex);
+            writerChar(w, ',');
+            writerInt(w, i);
+            writerChar(w, ',');
+            writerInt(w, path[i]->x);
+            writerChar(w, ',');
+            writerInt(w, path[i]->y);
+            writerChar(w, '\n');
         }
-        vA = vA->next;
+        w->pathIndex++;
+        return true;
+    }
+    writerString(w, "Path Founded: ");
+    for (int i = 0; i < length; i++) {
+        writerChar(w, '(');
+        writerInt(w, path[i]->x);
+        writerChar(w, ',');
+        writerInt(w, path[i]->y);
+        writerChar(w, ')');
+        if (i < length - 1) writerString(w, " -> ");
     }
+    writerChar(w, '\n');
+    return true;
 }
 
 /**
- * @brief Liberta toda a memória associada a um grafo
+ * @brief Escreve os caminhos simples entre duas antenas
+ * 
+ * Em CSV, cada caminho ocupa uma linha por passo (path,step,x,y).
  * 
+ * @param w Pointer para o escritor
  * @param g Pointer para o grafo
+ * @param ctx Pointer para o contexto de pesquisa
+ * @param x1 Coordenada x da origem
+ * @param y1 Coordenada y da origem
+ * @param x2 Coordenada x do destino
+ * @param y2 Coordenada y do destino
+ * @param frequency Frequência das antenas
+ * @param maxLength Número máximo de vértices de cada caminho, ou 0 para não limitar
+ * @param maxResults Número máximo de caminhos, ou 0 para não limitar
+ * @return int Número de caminhos escritos, ou -1 se um dos vértices não existir ou faltar memória
  */
-void freeGraph(Graph *g){
-    if (g == NULL) return;
+int writePaths(OutputWriter *w, Graph *g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char frequency,
+               int maxLength, int maxResults){
+    INSTRUMENT_FUNCTION();
+    if (w == NULL) return -1;
+    if (w->format == OUTPUT_CSV) writerString(w, "path,step,x,y\n");
+    w->pathIndex = 0;
+    return findPathsBounded(g, ctx, x1, y1, x2, y2, frequency, maxLength, maxResults, writePath, w);
+}
 
-    Vertex *v = g->vertices;
-    while (v != NULL) {
-        // Libertar a lista de adjacentes
-        AdjList *adj = v->adjacents;
+/** @brief Escreve um par de antenas vizinhas com frequências diferentes */
+static void writeIntersection(Vertex *a, Vertex *b, void *userData) {
+    OutputWriter *w = userData;
+    if (w->format == OUTPUT_CSV) {
+        writerInt(w, a->x);
+        writerChar(w, ',');
+        writerInt(w, a->y);
+        writerChar(w, ',');
+        writerCsvFrequency(w, a->frequency);
+        writerChar(w, ',');
+        writerInt(w, b->x);
+        writerChar(w, ',');
+        writerInt(w, b->y);
+        writerChar(w, ',');
+        writerCsvFrequency(w, b->frequency);
+        writerChar(w, '\n');
+        return;
+    }
+    writerString(w, "Intersection between (");
+    writerInt(w, a->x);
+    writerString(w, ", ");
+    writerInt(w, a->y);
+    writerString(w, ") [");
+    writerChar(w, a->frequency);
+    writerString(w, "] and (");
+    writerInt(w, b->x);
+    writerString(w, ", ");
+    writerInt(w, b->y);
+    writerString(w, ") [");
+    writerChar(w, b->frequency);
+    writerString(w, "]\n");
+}
 
-        while (adj != NULL) {
-            AdjList *tempAdj = adj;
-            adj = adj->next;
-            free(tempAdj);
-        }
-        // Libertar o vértice
-        Vertex *tempV = v;
-        v = v->next;
-        free(tempV);
+/**
+ * @brief Escreve os pares de antenas vizinhas com frequências A e B
+ * 
+ * @param w Pointer para o escritor
+ * @param g Pointer para o grafo
+ * @param frequencyA Frequência das antenas A
+ * @param frequencyB Frequência das antenas B
+ * @return int Número de pares escritos
+ */
+int writeIntersections(OutputWriter *w, Graph *g, char frequencyA, char frequencyB){
+    INSTRUMENT_FUNCTION();
+    if (w == NULL || g == NULL) return 0;
+    if (w->format == OUTPUT_CSV) writerString(w, "xA,yA,frequencyA,xB,yB,frequencyB\n");
+    return listIntersectionsVisit(g, frequencyA, frequencyB, writeIntersection, w);
+}
+
+/** @brief Escreve uma posição afetada pelo efeito nefasto */
+static void writeInterferencePoint(int x, int y, void *userData) {
+    OutputWriter *w = userData;
+    if (w->format == OUTPUT_CSV) {
+        writerInt(w, x);
+        writerChar(w, ',');
+        writerInt(w, y);
+        writerChar(w, '\n');
+        return;
     }
-    free(g);
-}
\ No newline at end of file
+    writerString(w, "Nefarious effect at (");
+    writerInt(w, x);
+    writerString(w, ", ");
+    writerInt(w, y);
+    writerString(w, ")\n");
+}
+
+/**
+ * @brief Escreve as posições afetadas pelo efeito nefasto, linha a linha
+ * 
+ * @param w Pointer para o escritor
+ * @param map Pointer para as posições calculadas pelo computeInterference
+ * @return long long Número de posições escritas
+ */
+long long writeInterference(OutputWriter *w, const InterferenceMap *map){
+    INSTRUMENT_FUNCTION();
+    if (w == NULL || map == NULL) return 0;
+    if (w->format == OUTPUT_CSV) writerString(w, "x,y\n");
+    return visitInterference(map, writeInterferencePoint, w);
+}
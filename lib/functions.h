@@ -14,25 +14,143 @@
 #include <stdbool.h>
 
 Graph *createGraph();
+Graph *createGraphWithMode(GraphMode mode);
+Graph *createGraphWithRange(int radius, int nearest);
 Vertex *createVertex(int x, int y, char frequency);
 void addVertex(Graph *g, int x, int y, char frequency);
-void addEdge(Vertex *a, Vertex *b);
+void addEdge(Graph *g, Vertex *a, Vertex *b);
+bool removeVertex(Graph *g, int x, int y, char frequency);
+bool moveVertex(Graph *g, int x, int y, char frequency, int newX, int newY);
+Vertex *findVertex(Graph *g, int x, int y, char frequency);
+void beginNeighbors(Graph *g, Vertex *v, NeighborCursor *c);
+Vertex *nextNeighbor(Graph *g, Vertex *v, NeighborCursor *c);
+
+/** Recebe cada vértice visitado */
+typedef void (*VertexVisitor)(Vertex *v, void *userData);
+/** Recebe cada ligação (from -> to) visitada */
+typedef void (*EdgeVisitor)(Vertex *from, Vertex *to, void *userData);
+void visitGraph(Graph *g, VertexVisitor visitVertex, EdgeVisitor visitEdge, void *userData);
 void printGraph(Graph *g);
 void freeGraph(Graph *g);
 
+//Componentes ligadas
+int componentOf(Graph *g, Vertex *v);
+bool sameComponent(Graph *g, Vertex *a, Vertex *b);
+int componentSize(Graph *g, Vertex *v);
+int componentCount(Graph *g);
+
 Graph *readGraphFromFile(const char *filename);
+Graph *readGraphFromFileWithMode(const char *filename, GraphMode mode);
+Graph *readGraphFromFileWithRange(const char *filename, int radius, int nearest);
+bool reloadGraphFromFile(Graph *g, const char *filename, ReloadStats *stats);
+Graph *readGraphFromFileMapped(const char *filename, GraphMode mode, int threadCount);
+Graph *buildGraphParallel(const AntennaCell *cells, int count, GraphMode mode, int threadCount);
 void writeGraphToBinary(const char *filename, Graph *g);
 Graph *readGraphFromBinary(const char *filename);
+Graph *readGraphFromBinaryWithMode(const char *filename, GraphMode mode);
+
+//Contexto de pesquisa
+TraversalContext *createTraversalContext();
+void freeTraversalContext(TraversalContext *ctx);
 
 //DFS
 void depthFirstSearch(Graph* g, int startX, int startY, char freq);
+void depthFirstSearchWithContext(Graph* g, TraversalContext *ctx, int startX, int startY, char freq);
+bool depthFirstSearchVisit(Graph* g, TraversalContext *ctx, int startX, int startY, char freq,
+                           VertexVisitor visit, void *userData);
 //BFS
 void breadthFirstSearch(Graph* g, int startX, int startY, char freq);
+void breadthFirstSearchWithContext(Graph* g, TraversalContext *ctx, int startX, int startY, char freq);
+bool breadthFirstSearchVisit(Graph* g, TraversalContext *ctx, int startX, int startY, char freq,
+                             VertexVisitor visit, void *userData);
 //FAP
 void findAllPaths(Graph* g, int x1, int y1, int x2, int y2, char freq);
+void findAllPathsWithContext(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char freq);
+
+/** Recebe cada caminho encontrado (path[0] é a origem); devolve false para terminar a procura */
+typedef bool (*PathVisitor)(Vertex **path, int length, void *userData);
+int findPathsBounded(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char freq,
+                     int maxLength, int maxResults, PathVisitor visit, void *userData);
+bool countPaths(Graph* g, int x1, int y1, int x2, int y2, char freq, int maxLength, unsigned long long *count);
+int shortestPath(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char freq,
+                 Vertex **path, int capacity);
+int shortestPathWeighted(Graph* g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char freq,
+                         Vertex **path, int capacity, double *cost);
 //LIBF
 void listIntersectionsBetweenFrequencies(Graph *g, char frequencyA, char frequencyB);
 
+/** Recebe cada intersecção encontrada pelo listIntersectionsVisit e pelo listAllIntersections */
+typedef void (*IntersectionSink)(Vertex *a, Vertex *b, void *userData);
+int listIntersectionsVisit(Graph *g, char frequencyA, char frequencyB, IntersectionSink sink, void *userData);
+int listAllIntersections(Graph *g, const char *pairs, int pairCount, IntersectionSink sink, void *userData);
+
+//Efeito nefasto
+/** Recebe cada posição afetada encontrada pelo visitInterference */
+typedef void (*PointVisitor)(int x, int y, void *userData);
+InterferenceMap *computeInterference(Graph *g, int threadCount);
+bool interferenceAt(const InterferenceMap *map, int x, int y);
+long long visitInterference(const InterferenceMap *map, PointVisitor visit, void *userData);
+void freeInterferenceMap(InterferenceMap *map);
+
+//Lotes de consultas
+void runQueryBatch(Graph *g, const Query *queries, QueryResult *results, int count, int threadCount);
+void freeQueryResults(QueryResult *results, int count);
+
+//Cache de consultas
+QueryCache *createQueryCache(Graph *g, int capacity);
+const QueryResult *cachedQuery(QueryCache *cache, const Query *q);
+void clearQueryCache(QueryCache *cache);
+void freeQueryCache(QueryCache *cache);
+
+//CSR
+CsrGraph *buildCsrGraph(Graph *g);
+CsrGraph *readCsrGraphFromFile(const char *filename);
+int csrFindVertex(CsrGraph *csr, int x, int y, char frequency);
+void printCsrGraph(CsrGraph *csr);
+void csrDepthFirstSearch(CsrGraph *csr, int startX, int startY, char frequency);
+void csrBreadthFirstSearch(CsrGraph *csr, int startX, int startY, char frequency);
+int csrBreadthFirstDistances(CsrGraph *csr, int startX, int startY, char frequency, int *distances);
+void csrFindAllPaths(CsrGraph *csr, int x1, int y1, int x2, int y2, char frequency);
+void freeCsrGraph(CsrGraph *csr);
+
+//Snapshot
+bool writeCsrSnapshot(const char *filename, CsrGraph *csr);
+bool writeGraphSnapshot(const char *filename, Graph *g);
+CsrGraph *openCsrSnapshot(const char *filename, bool verifyChecksum);
+
+//Grafo em blocos no disco
+/** Recebe cada antena visitada numa pesquisa sobre um TiledGraph */
+typedef void (*CellVisitor)(const AntennaCell *cell, void *userData);
+/** Recebe cada par de antenas vizinhas encontrado pelo tiledListIntersections */
+typedef void (*CellPairSink)(const AntennaCell *a, const AntennaCell *b, void *userData);
+bool writeTiledGraph(const char *textFile, const char *tiledFile, int tileSize);
+TiledGraph *openTiledGraph(const char *filename, size_t memoryBudget, int radius);
+void closeTiledGraph(TiledGraph *t);
+bool tiledFindAntenna(TiledGraph *t, int x, int y, char freq, AntennaCell *cell);
+bool tiledDepthFirstSearch(TiledGraph *t, int startX, int startY, char freq, CellVisitor visit, void *userData);
+bool tiledBreadthFirstSearch(TiledGraph *t, int startX, int startY, char freq, CellVisitor visit, void *userData);
+long long tiledListIntersections(TiledGraph *t, char frequencyA, char frequencyB, CellPairSink sink, void *userData);
+
+//Escrita dos resultados
+OutputWriter *createOutputWriter(FILE *file, OutputFormat format);
+void writeText(OutputWriter *w, const char *text);
+void writeGraph(OutputWriter *w, Graph *g);
+bool writeDepthFirstSearch(OutputWriter *w, Graph *g, TraversalContext *ctx, int startX, int startY, char freq);
+bool writeBreadthFirstSearch(OutputWriter *w, Graph *g, TraversalContext *ctx, int startX, int startY, char freq);
+int writePaths(OutputWriter *w, Graph *g, TraversalContext *ctx, int x1, int y1, int x2, int y2, char freq,
+               int maxLength, int maxResults);
+int writeIntersections(OutputWriter *w, Graph *g, char frequencyA, char frequencyB);
+long long writeInterference(OutputWriter *w, const InterferenceMap *map);
+bool flushOutputWriter(OutputWriter *w);
+bool freeOutputWriter(OutputWriter *w);
+
+//Instrumentação
+void setInstrumentation(bool enabled);
+bool instrumentationEnabled();
+void resetInstrumentation();
+unsigned long long instrumentationCounter(InstrumentCounter counter);
+bool writeInstrumentationReport(FILE *f);
+
 
 
 #endif
\ No newline at end of file
@@ -11,6 +11,30 @@
 #ifndef structs_h
 #define structs_h
 
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Número de frequências possíveis (uma por valor de char) */
+#define FREQUENCY_COUNT 256
+
+/**
+ * @enum GraphMode
+ * @brief Forma como as ligações entre antenas da mesma frequência são representadas.
+ * 
+ * No modo explícito cada ligação é um nó AdjList (k·(k−1) nós para k antenas da mesma frequência).
+ * No modo implícito as ligações são deduzidas da lista de membros de cada frequência,
+ * pelo que a memória e o tempo de construção crescem linearmente com o número de antenas.
+ * No modo por alcance só as antenas da mesma frequência próximas umas das outras (dentro
+ * de um raio, ou as k mais próximas) ficam ligadas, com nós AdjList como no modo explícito.
+ */
+typedef enum GraphMode{
+    GRAPH_EXPLICIT,
+    GRAPH_IMPLICIT,
+    GRAPH_RANGED
+} GraphMode;
+
 /**
  * @struct AdjList
  * @brief Representa uma aresta (ligação) entre vértices no grafo.
@@ -21,6 +45,8 @@
 typedef struct AdjList{
     struct Vertex *vertex; //Pointer que aponta para o vértice de destino da ligação
     struct AdjList *next; //Pointer para o próximo vértice daa lista ligada de arestas
+    struct AdjList *prev; // Nó anterior da mesma lista, para remover a ligação em O(1)
+    struct AdjList *twin; // Nó da ligação inversa, na lista do vértice de destino
 } AdjList;
 
 /**
@@ -28,25 +54,503 @@ typedef struct AdjList{
  * @brief Representa um vértice (Antena) no grafo.
  * 
  * Contém informação posicional (x, y), uma frequência (carácter), 
- * um marcador de visitação para algoritmos de grafos, e ponteiros 
+ * um identificador usado pelos contextos de pesquisa, e ponteiros 
  * para listas de adjacência e para o próximo vértice.
  */
 typedef struct Vertex{ 
     int x, y;
     char frequency;
-    bool visited; // para o DFS e BFS, serve para evitar visitar o mesmo vértice mais do que uma vez
+    int id; // Identificador atribuído pelo addVertex, menor que o idLimit do grafo (reutilizado após removeVertex)
     struct AdjList *adjacents; //Pointer para o próximo vértice daa lista ligada de vértices
     struct Vertex *next; //Pointer que permite cirar  uma lista ligada de vaarias conexões (arestas neste caso)
+    struct Vertex *prev; // Vértice anterior na lista do grafo, para remover o vértice em O(1)
+    struct Vertex *freqPrev; // Membro anterior (mais antigo) da mesma frequência
+    struct Vertex *freqNext; // Membro seguinte (mais recente) da mesma frequência
+    struct Vertex *cellNext; // Próximo vértice da mesma célula da grelha espacial (modo GRAPH_RANGED)
 } Vertex;
 
+/**
+ * @struct PoolBlock
+ * @brief Bloco de memória (slab) de um NodePool.
+ * 
+ * Os nós do pool ficam guardados logo a seguir a este cabeçalho.
+ */
+typedef struct PoolBlock{
+    struct PoolBlock *next; // Bloco alocado anteriormente
+} PoolBlock;
+
+/**
+ * @struct NodePool
+ * @brief Alocador de nós de tamanho fixo (vértices ou nós de adjacência) do grafo.
+ * 
+ * Os nós são atribuídos por avanço de um cursor dentro do bloco atual, pelo que nós criados
+ * seguidos ficam contíguos em memória. Os nós devolvidos ficam numa lista de livres para
+ * serem reutilizados, e toda a memória é libertada bloco a bloco, de uma só vez.
+ */
+typedef struct NodePool{
+    size_t itemSize; // Tamanho de cada nó, arredondado ao alinhamento
+    int nextBlockItems; // Número de nós do próximo bloco (cresce até um máximo)
+    PoolBlock *blocks; // Lista de blocos alocados
+    char *cursor; // Próximo nó livre do bloco atual
+    char *limit; // Fim do bloco atual
+    void *freeList; // Nós devolvidos, reutilizados antes de avançar o cursor
+} NodePool;
+
+/**
+ * @struct VertexIndex
+ * @brief Índice de coordenadas para encontrar um vértice por (x, y, frequência) em O(1).
+ * 
+ * Tabela de hash de endereçamento aberto com sondagem linear. O hash usa apenas (x, y),
+ * pelo que todas as antenas da mesma posição ficam no mesmo bloco contíguo de posições
+ * e podem ser encontradas sem conhecer a frequência.
+ */
+typedef struct VertexIndex{
+    Vertex **slots; // Posições da tabela, NULL quando vazia
+    int capacity; // Número de posições (potência de 2)
+    int count; // Número de vértices indexados
+} VertexIndex;
+
+/**
+ * @struct SpatialCell
+ * @brief Célula da grelha espacial: antenas de uma frequência numa área cellSize × cellSize.
+ */
+typedef struct SpatialCell{
+    int cx, cy; // Coordenadas da célula (coordenada da antena dividida por cellSize)
+    char frequency;
+    bool used; // false enquanto a posição da tabela está livre
+    Vertex *members; // Lista ligada pelo cellNext, NULL se a célula ficou vazia
+} SpatialCell;
+
+/**
+ * @struct SpatialGrid
+ * @brief Grelha uniforme usada pelo modo GRAPH_RANGED para encontrar as antenas próximas.
+ * 
+ * As células ocupadas ficam numa tabela de hash de endereçamento aberto indexada por
+ * (célula, frequência). Com raio, o lado das células é o raio, pelo que as antenas a ligar
+ * estão sempre nas 3 × 3 células à volta da nova antena.
+ */
+typedef struct SpatialGrid{
+    SpatialCell *cells; // Posições da tabela
+    int capacity; // Número de posições (potência de 2)
+    int count; // Posições ocupadas
+    int cellSize; // Lado de cada célula
+    int radius; // Distância máxima das ligações (0 = sem limite)
+    int nearest; // Número máximo de ligações de cada nova antena (0 = sem limite)
+    Vertex **best; // nearest posições: candidatos mais próximos encontrados
+    long long *bestDistance; // Quadrado da distância de cada candidato
+} SpatialGrid;
+
+/**
+ * @struct ComponentSet
+ * @brief Union-find das componentes ligadas do grafo, indexado pelo id dos vértices.
+ * 
+ * Só as ligações entre antenas da mesma frequência contam, tal como nas pesquisas.
+ * As uniões são por tamanho e comprimem os caminhos; as consultas só leem a floresta,
+ * pelo que várias threads podem consultar o mesmo grafo ao mesmo tempo.
+ */
+typedef struct ComponentSet{
+    int *parent; // Pai de cada vértice na floresta (uma raiz é pai de si própria)
+    int *size; // Número de vértices de cada componente, válido nas raízes
+    int capacity; // Capacidade de parent e size
+    int count; // Número de componentes
+} ComponentSet;
+
+/**
+ * @struct RowDigest
+ * @brief Hash de cada linha do último ficheiro de texto lido para um grafo.
+ * 
+ * Permite ao reloadGraphFromFile saltar as linhas que não mudaram. Só descreve o grafo
+ * enquanto a versão do grafo for igual a version.
+ */
+typedef struct RowDigest{
+    uint64_t *hashes; // Hash das células de cada linha (sem espaços)
+    int count; // Número de linhas com hash
+    int capacity;
+    unsigned long long version; // Versão do grafo quando os hashes foram calculados
+} RowDigest;
+
+/**
+ * @struct ReloadStats
+ * @brief Alterações aplicadas por um reloadGraphFromFile.
+ */
+typedef struct ReloadStats{
+    int rowsSkipped; // Linhas com o mesmo hash da última leitura, não comparadas
+    int rowsCompared; // Linhas comparadas célula a célula
+    int added; // Antenas novas
+    int removed; // Antenas retiradas
+    int changed; // Células cuja antena mudou de frequência
+} ReloadStats;
+
 /**
  * @struct Graph
  * @brief Estrutura principal que representa o grafo.
  * 
- * Contém um pointer para o primeiro vértice da lista de vértices.
+ * Contém um pointer para o primeiro vértice da lista de vértices e, para cada frequência,
+ * a lista de membros pela ordem de inserção.
  */
 typedef struct Graph{
     Vertex *vertices; // Cabeça da lista dos vértices
+    int vertexCount; // Número de vértices na lista
+    int idLimit; // Todos os ids em uso são menores que este valor
+    int *freeIds; // Ids libertados pelo removeVertex, reutilizados pelo addVertex
+    int freeIdCount;
+    int freeIdCapacity;
+    GraphMode mode; // Representação das ligações da mesma frequência
+    int rows; // Linhas da matriz lida, ou a menor que contém as antenas inseridas
+    int cols; // Colunas da matriz lida, ou a menor que contém as antenas inseridas
+    Vertex *frequencyHead[FREQUENCY_COUNT]; // Membro mais antigo de cada frequência
+    Vertex *frequencyTail[FREQUENCY_COUNT]; // Membro mais recente de cada frequência
+    int frequencyCount[FREQUENCY_COUNT]; // Número de membros de cada frequência
+    VertexIndex index; // Índice de coordenadas mantido pelo addVertex
+    ComponentSet components; // Componentes ligadas mantidas pelo addVertex e addEdge
+    SpatialGrid grid; // Grelha espacial e limites de alcance (só no modo GRAPH_RANGED)
+    NodePool vertexPool; // Memória dos vértices do grafo
+    NodePool edgePool; // Memória dos nós AdjList do grafo
+    unsigned long long version; // Incrementada por cada alteração (addVertex, addEdge, removeVertex, moveVertex)
+    RowDigest rowDigest; // Hashes das linhas do ficheiro de texto lido (readGraphFromFile)
 } Graph;
 
-#endif
\ No newline at end of file
+/**
+ * @struct NeighborCursor
+ * @brief Posição de uma iteração sobre os adjacentes de um vértice.
+ * 
+ * Permite percorrer os adjacentes da mesma forma nos dois modos do grafo:
+ * no modo explícito segue a lista AdjList, no modo implícito percorre primeiro
+ * os membros mais recentes da frequência (do mais recente para o mais antigo)
+ * e depois os mais antigos (do mais antigo para o mais recente), que é exatamente
+ * a ordem em que o addVertex deixa a lista AdjList no modo explícito.
+ */
+typedef struct NeighborCursor{
+    AdjList *adj; // Próximo nó da lista de adjacência (modo explícito)
+    Vertex *member; // Próximo membro da frequência a devolver (modo implícito)
+    int phase; // 0 = membros mais recentes, 1 = membros mais antigos, 2 = terminado
+} NeighborCursor;
+
+/**
+ * @struct TraversalFrame
+ * @brief Entrada da pilha de uma pesquisa iterativa (DFS ou caminhos).
+ */
+typedef struct TraversalFrame{
+    Vertex *vertex; // Vértice desta posição da pilha
+    NeighborCursor cursor; // Próximo adjacente do vértice a explorar
+} TraversalFrame;
+
+/**
+ * @struct RouteEntry
+ * @brief Entrada da fila de prioridade do A* (shortestPathWeighted).
+ */
+typedef struct RouteEntry{
+    double priority; // Custo desde a origem mais a estimativa até ao destino
+    double cost; // Custo desde a origem quando a entrada foi criada
+    Vertex *vertex;
+} RouteEntry;
+
+/**
+ * @struct TraversalContext
+ * @brief Estado de uma pesquisa, guardado fora do grafo.
+ * 
+ * Um vértice está visitado na pesquisa atual se marks[id] for igual a epoch; cada nova
+ * pesquisa só tem de incrementar epoch, sem percorrer os vértices. Como o grafo não é
+ * alterado, várias pesquisas podem correr em paralelo, cada uma com o seu contexto.
+ */
+typedef struct TraversalContext{
+    unsigned int *marks; // Época em que cada vértice (por id) foi visitado
+    int markCapacity;
+    unsigned int epoch; // Época da pesquisa atual
+    TraversalFrame *frames; // Pilha do DFS ou caminho atual da procura de caminhos
+    Vertex **path; // Vértices das entradas da pilha, seguidos, para entregar o caminho atual
+    int frameCapacity; // Capacidade de frames e de path
+    Vertex **queue; // Fila circular do BFS, cresce quando fica cheia
+    int queueCapacity; // Potência de 2
+    int queueHead; // Posição do próximo vértice a sair da fila
+    int queueCount; // Número de vértices na fila
+    Vertex **parents; // Predecessor de cada vértice (por id) no caminho mais curto
+    double *costs; // Custo desde a origem de cada vértice (por id), no A*
+    Vertex **discovered; // Vértices descobertos por cada ponta da pesquisa bidirecional (2 metades)
+    int routeCapacity; // Capacidade de parents, costs e de cada metade de discovered
+    RouteEntry *heap; // Fila de prioridade do A*
+    int heapCount;
+    int heapCapacity;
+} TraversalContext;
+
+/**
+ * @enum QueryKind
+ * @brief Tipo de uma consulta do runQueryBatch.
+ */
+typedef enum QueryKind{
+    QUERY_DFS, // Vértices alcançados por DFS a partir de (x1, y1)
+    QUERY_BFS, // Vértices alcançados por BFS a partir de (x1, y1)
+    QUERY_PATHS, // Todos os caminhos entre (x1, y1) e (x2, y2)
+    QUERY_INTERSECTIONS, // Intersecções entre as frequências frequency e frequencyB
+    QUERY_REACHABLE, // Se (x2, y2) é alcançável a partir de (x1, y1), sem pesquisa
+    QUERY_SHORTEST_PATH // Caminho com menos ligações entre (x1, y1) e (x2, y2)
+} QueryKind;
+
+/**
+ * @struct Query
+ * @brief Uma consulta de um lote executado pelo runQueryBatch.
+ */
+typedef struct Query{
+    QueryKind kind;
+    int x1, y1; // Vértice inicial (DFS, BFS) ou de origem (caminhos)
+    int x2, y2; // Vértice de destino (caminhos, alcançabilidade)
+    char frequency; // Frequência dos vértices, ou frequência A (intersecções)
+    char frequencyB; // Frequência B (intersecções)
+    int maxLength; // Caminhos: número máximo de vértices de cada caminho (0 = sem limite)
+    int maxResults; // Caminhos: número máximo de caminhos (0 = sem limite)
+} Query;
+
+/**
+ * @struct QueryResult
+ * @brief Resultado de uma consulta do runQueryBatch.
+ * 
+ * DFS e BFS: vertices tem os vértices pela ordem de visita.
+ * Caminhos: vertices tem os vértices de todos os caminhos seguidos, e pathLengths o
+ * comprimento de cada um dos pathCount caminhos.
+ * Intersecções: vertices tem pathCount pares seguidos (antena A, antena B).
+ * Alcançabilidade: só reachable é preenchido.
+ * Caminho mais curto: vertices tem o caminho (pathCount = 1) se reachable for true.
+ */
+typedef struct QueryResult{
+    bool found; // false se o vértice inicial ou de destino não existir
+    bool failed; // true se faltou memória durante a consulta
+    bool reachable; // Alcançabilidade: true se os dois vértices estão na mesma componente
+    Vertex **vertices;
+    int vertexCount;
+    int vertexCapacity;
+    int *pathLengths;
+    int pathCount;
+    int pathCapacity;
+} QueryResult;
+
+/**
+ * @struct QueryCacheEntry
+ * @brief Resultado guardado pelo QueryCache.
+ */
+typedef struct QueryCacheEntry{
+    Query key; // Consulta, só com os campos usados pelo seu tipo (os restantes a 0)
+    unsigned int hash;
+    QueryResult result;
+    struct QueryCacheEntry *chain; // Próxima entrada do mesmo balde da tabela de hash
+    struct QueryCacheEntry *newer; // Lista LRU, da entrada usada mais recentemente para a mais antiga
+    struct QueryCacheEntry *older;
+} QueryCacheEntry;
+
+/**
+ * @struct QueryCache
+ * @brief Resultados de consultas repetidas sobre um grafo, com descarte LRU.
+ * 
+ * Os resultados são válidos enquanto a versão do grafo for igual a version; quando o
+ * grafo muda, todos são descartados na consulta seguinte.
+ */
+typedef struct QueryCache{
+    Graph *g;
+    unsigned long long version; // Versão do grafo dos resultados guardados
+    QueryCacheEntry **buckets; // Tabela de hash, com encadeamento
+    int bucketCount; // Potência de 2
+    QueryCacheEntry *newest; // Extremos da lista LRU
+    QueryCacheEntry *oldest;
+    int count;
+    int capacity; // Número máximo de resultados guardados
+    QueryResult uncached; // Resultado de uma consulta que falhou, que não é guardado
+    TraversalContext *ctx; // Contexto das consultas executadas pela cache
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions; // Resultados descartados por falta de espaço
+    unsigned long long invalidations; // Vezes que os resultados foram descartados por o grafo ter mudado
+} QueryCache;
+
+/**
+ * @enum InstrumentCounter
+ * @brief Contadores da instrumentação da biblioteca.
+ */
+typedef enum InstrumentCounter{
+    INSTRUMENT_VERTICES, // Vértices inseridos pelo addVertex
+    INSTRUMENT_EDGES, // Ligações criadas pelo addEdge
+    INSTRUMENT_ALLOCATIONS, // Alocações de pools, índices, componentes, contextos e CSR
+    INSTRUMENT_ALLOCATED_BYTES, // Bytes dessas alocações
+    INSTRUMENT_BYTES_READ, // Bytes lidos de ficheiros de texto, binários e snapshots
+    INSTRUMENT_BYTES_WRITTEN, // Bytes escritos em ficheiros binários, snapshots e pelo OutputWriter
+    INSTRUMENT_COUNTER_COUNT
+} InstrumentCounter;
+
+/** Tamanho do buffer de um OutputWriter */
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @enum OutputFormat
+ * @brief Formato dos resultados escritos por um OutputWriter.
+ */
+typedef enum OutputFormat{
+    OUTPUT_TEXT, // O mesmo texto que o printGraph, DFS, BFS, findAllPaths e intersecções imprimem
+    OUTPUT_CSV // Uma linha por resultado, com uma linha de cabeçalho por bloco
+} OutputFormat;
+
+/**
+ * @struct OutputWriter
+ * @brief Escritor com buffer para os resultados das pesquisas.
+ * 
+ * Os resultados são formatados diretamente no buffer, sem printf, e só são enviados
+ * para o ficheiro quando o buffer enche ou quando é feito flush.
+ */
+typedef struct OutputWriter{
+    FILE *file; // Destino dos resultados
+    OutputFormat format;
+    size_t length; // Bytes ocupados no buffer
+    bool failed; // true se alguma escrita no ficheiro falhou
+    bool lineOpen; // Texto do grafo: linha do vértice atual ainda por terminar
+    long pathIndex; // CSV dos caminhos: número do caminho atual
+    char buffer[OUTPUT_BUFFER_SIZE];
+} OutputWriter;
+
+/**
+ * @struct InterferenceMap
+ * @brief Posições da matriz afetadas pelo efeito nefasto dos pares de antenas.
+ * 
+ * Cada par de antenas A, B da mesma frequência afeta as posições 2A − B e 2B − A
+ * (o prolongamento do segmento AB para lá de cada antena), se estiverem dentro da matriz.
+ * As posições são bits de um bitmap linha a linha: a posição (x, y) é o bit x * cols + y.
+ */
+typedef struct InterferenceMap{
+    int rows;
+    int cols;
+    uint64_t *bits; // (rows * cols + 63) / 64 palavras
+    long long count; // Número de posições distintas afetadas
+} InterferenceMap;
+
+/**
+ * @struct AntennaCell
+ * @brief Antena lida de um ficheiro de texto, antes de ser inserida no grafo.
+ */
+typedef struct AntennaCell{
+    int x, y; // Linha e coluna (sem contar espaços) da antena
+    char frequency;
+} AntennaCell;
+
+/**
+ * @struct CsrGraph
+ * @brief Representação compacta (Compressed Sparse Row) do grafo.
+ * 
+ * Os vértices são guardados em arrays contíguos (x, y e frequência), indexados
+ * pela posição do vértice na lista do grafo original. As arestas do vértice i
+ * ocupam targets[offsets[i]] até targets[offsets[i + 1] - 1], pela mesma ordem
+ * da lista de adjacência original.
+ */
+typedef struct CsrGraph{
+    int vertexCount;
+    int edgeCount;
+    int *xs; // Coordenada x de cada vértice
+    int *ys; // Coordenada y de cada vértice
+    char *frequencies; // Frequência de cada vértice
+    int *offsets; // vertexCount + 1 posições, início das arestas de cada vértice
+    int *targets; // edgeCount posições, índice do vértice de destino de cada aresta
+    void *mapping; // Snapshot mapeado onde estão os arrays, ou NULL se foram alocados
+    size_t mappingSize; // Tamanho do mapeamento
+} CsrGraph;
+
+/** Identificação dos ficheiros de snapshot */
+#define SNAPSHOT_MAGIC "ANTSNAP"
+/** Versão atual do formato de snapshot */
+#define SNAPSHOT_VERSION 1
+/** Valor escrito para detetar snapshots criados numa máquina com outra ordem de bytes */
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+/**
+ * @struct SnapshotHeader
+ * @brief Cabeçalho de um snapshot binário de um CsrGraph.
+ * 
+ * O cabeçalho é seguido pelos arrays do CsrGraph (xs, ys, frequencies, offsets e targets),
+ * cada um a começar numa posição múltipla de 8, pelo que o ficheiro pode ser mapeado
+ * com mmap e usado diretamente, sem converter elemento a elemento.
+ */
+typedef struct SnapshotHeader{
+    char magic[8]; // SNAPSHOT_MAGIC
+    uint32_t version; // SNAPSHOT_VERSION
+    uint32_t byteOrder; // SNAPSHOT_BYTE_ORDER
+    int32_t vertexCount;
+    int32_t edgeCount;
+    uint64_t checksum; // FNV-1a de 64 bits de tudo o que vem depois do cabeçalho
+    uint64_t xsOffset; // Posição de cada array no ficheiro
+    uint64_t ysOffset;
+    uint64_t frequenciesOffset;
+    uint64_t offsetsOffset;
+    uint64_t targetsOffset;
+    uint64_t fileSize; // Tamanho total do ficheiro
+} SnapshotHeader;
+
+/** Identificação dos ficheiros de blocos (grafo em disco) */
+#define TILED_MAGIC "ANTTILE"
+/** Versão atual do formato de blocos */
+#define TILED_VERSION 1
+
+/**
+ * @struct TiledHeader
+ * @brief Cabeçalho de um ficheiro de blocos criado pelo writeTiledGraph.
+ * 
+ * A matriz é dividida em blocos de tileSize × tileSize posições. O cabeçalho é seguido
+ * pelas antenas de cada bloco (AntennaCell ordenadas por linha, coluna e frequência),
+ * bloco a bloco, e no fim pelo diretório com um TileEntry por bloco, linha a linha.
+ */
+typedef struct TiledHeader{
+    char magic[8]; // TILED_MAGIC
+    uint32_t version; // TILED_VERSION
+    uint32_t byteOrder; // SNAPSHOT_BYTE_ORDER
+    int32_t tileSize; // Lado de cada bloco
+    int32_t rows; // Dimensões da matriz
+    int32_t cols;
+    int32_t tileRows; // Número de blocos em cada direção
+    int32_t tileCols;
+    uint64_t antennaCount;
+    uint64_t directoryOffset; // Posição do diretório no ficheiro
+} TiledHeader;
+
+/**
+ * @struct TileEntry
+ * @brief Posição de um bloco no ficheiro e frequências que contém.
+ */
+typedef struct TileEntry{
+    uint64_t offset; // Posição da primeira antena do bloco
+    uint32_t count; // Número de antenas do bloco
+    uint32_t reserved;
+    uint64_t frequencies[FREQUENCY_COUNT / 64]; // Bit f ligado se o bloco tem antenas da frequência f
+} TileEntry;
+
+/**
+ * @struct Tile
+ * @brief Bloco carregado em memória pelo TiledGraph.
+ */
+typedef struct Tile{
+    int index; // Posição no diretório
+    int count;
+    int pins; // Utilizações em curso: um bloco com pins > 0 não é descarregado
+    AntennaCell *cells; // Antenas ordenadas por linha, coluna e frequência
+    struct Tile *newer; // Lista LRU, do bloco usado mais recentemente para o mais antigo
+    struct Tile *older;
+} Tile;
+
+/**
+ * @struct TiledGraph
+ * @brief Grafo guardado num ficheiro de blocos, carregados a pedido numa cache LRU.
+ * 
+ * As ligações não são guardadas: as antenas da mesma frequência estão todas ligadas,
+ * como no Graph, ou só as que estão a uma distância não superior a radius, como no modo
+ * GRAPH_RANGED. Os blocos usados menos recentemente são descarregados quando a memória
+ * dos blocos carregados passa de memoryBudget. Não é seguro usar o mesmo TiledGraph em
+ * várias threads ao mesmo tempo.
+ */
+typedef struct TiledGraph{
+    int fd;
+    TiledHeader header;
+    TileEntry *directory; // tileRows × tileCols entradas
+    Tile **tiles; // Bloco carregado de cada entrada do diretório, ou NULL
+    Tile *newest; // Extremos da lista LRU
+    Tile *oldest;
+    size_t memoryBudget; // Bytes máximos dos blocos carregados (0 = sem limite)
+    size_t memoryUsed;
+    int radius; // Distância máxima das ligações (0 = toda a frequência)
+    unsigned long long hits; // Pedidos de blocos já carregados
+    unsigned long long misses; // Blocos lidos do ficheiro
+    unsigned long long evictions; // Blocos descarregados para respeitar o orçamento
+} TiledGraph;
+
+#endif
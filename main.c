@@ -16,59 +16,363 @@
  * - Procura em largura a partir de uma determinada antena
  * - Procura todos os caminhos entre duas antenas
  * - Lista todas as intersecções entre duas frequencias diferentes 
+ * - Lista as posições da matriz afetadas pelo efeito nefasto
  * - Liberta a memória de ambos os grafos criados
  * 
+ * Sem argumentos executa a demonstração acima sobre data/antennasFile1.txt. Com um
+ * ficheiro de comandos (ou "-" para os ler do stdin) carrega o grafo uma vez e executa
+ * os comandos sobre o mesmo grafo, um por linha:
+ * 
+ *     load <ficheiro> [explicit|implicit|ranged <raio> [vizinhos]]
+ *     loadbin <ficheiro>            save <ficheiro>           reload <ficheiro>
+ *     add <x> <y> <f>               remove <x> <y> <f>        move <x> <y> <f> <x2> <y2>
+ *     dfs <x> <y> <f>               bfs <x> <y> <f>
+ *     paths <x1> <y1> <x2> <y2> <f> [comprimento máximo] [máximo de caminhos]
+ *     intersect <fA> <fB>           effects
+ *     print                         stats
+ *     format text|csv               quit
+ * 
+ * Linhas vazias e começadas por '#' são ignoradas. Os resultados vão para o stdout e o
+ * tempo de cada comando para o stderr.
+ * 
+ * Utilização: graphTP [ficheiro de comandos | -]
+ * 
  * @date 2025-05-08
  * 
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <time.h>
 #include "lib/functions.h"
 
-int main() {
+/** Número máximo de palavras de um comando */
+#define MAX_WORDS 10
+
+/**
+ * @struct Session
+ * @brief Estado mantido entre os comandos de um script.
+ */
+typedef struct Session{
+    OutputWriter *out; // Escritor dos resultados (stdout)
+    OutputFormat format;
+    Graph *g; // Grafo carregado, ou NULL
+    TraversalContext *ctx;
+} Session;
+
+/** @brief Tempo monotónico atual em nanossegundos */
+static long long nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/** @brief Converte uma palavra num inteiro; devolve false se não for um inteiro */
+static bool parseInt(const char *word, int *value) {
+    char *end;
+    long parsed = strtol(word, &end, 10);
+    if (end == word || *end != '\0') return false;
+    *value = (int)parsed;
+    return true;
+}
+
+/** @brief Converte uma palavra numa frequência (um único carácter) */
+static bool parseFrequency(const char *word, char *frequency) {
+    if (word[0] == '\0' || word[1] != '\0' || word[0] == '.') return false;
+    *frequency = word[0];
+    return true;
+}
+
+/** @brief Converte as palavras from..from+count-1 em inteiros */
+static bool parseInts(char **words, int from, int count, int *values) {
+    for (int i = 0; i < count; i++) {
+        if (!parseInt(words[from + i], &values[i])) return false;
+    }
+    return true;
+}
+
+/** @brief Substitui o grafo da sessão por um grafo acabado de ler */
+static bool replaceGraph(Session *s, Graph *g) {
+    if (g == NULL) return false;
+    freeGraph(s->g);
+    s->g = g;
+    return true;
+}
+
+/** @brief Escreve as estatísticas do grafo da sessão */
+static void writeStats(Session *s) {
+    static const char *modes[] = { "explicit", "implicit", "ranged" };
+    Graph *g = s->g;
+    int frequencies = 0;
+    for (int f = 0; f < FREQUENCY_COUNT; f++) {
+        if (g->frequencyCount[f] > 0) frequencies++;
+    }
+    char line[256];
+    snprintf(line, sizeof(line),
+             "Mode: %s\nMatrix: %d x %d\nAntennas: %d\nFrequencies: %d\nComponents: %d\nVersion: %llu\n",
+             modes[g->mode], g->rows, g->cols, g->vertexCount, frequencies, componentCount(g), g->version);
+    writeText(s->out, line);
+}
+
+/**
+ * @brief Executa um comando de um script sobre a sessão
+ * 
+ * @param s Pointer para a sessão
+ * @param words Palavras do comando (words[0] é o nome)
+ * @param count Número de palavras
+ * @param quit Fica true se o comando for quit
+ * @return const char* NULL se o comando foi executado, ou a descrição do erro
+ */
+static const char *runCommand(Session *s, char **words, int count, bool *quit) {
+    const char *name = words[0];
+    int v[7];
+    char f, fB;
+
+    if (strcmp(name, "quit") == 0 || strcmp(name, "exit") == 0) {
+        *quit = true;
+        return NULL;
+    }
+    if (strcmp(name, "format") == 0) {
+        if (count != 2) return "usage: format text|csv";
+        OutputFormat format;
+        if (strcmp(words[1], "text") == 0) format = OUTPUT_TEXT;
+        else if (strcmp(words[1], "csv") == 0) format = OUTPUT_CSV;
+        else return "usage: format text|csv";
+        OutputWriter *out = createOutputWriter(stdout, format);
+        if (out == NULL) return "out of memory";
+        freeOutputWriter(s->out);
+        s->out = out;
+        s->format = format;
+        return NULL;
+    }
+    if (strcmp(name, "load") == 0) {
+        if (count < 2 || count > 5) return "usage: load <file> [explicit|implicit|ranged <radius> [nearest]]";
+        Graph *g;
+        if (count == 2 || strcmp(words[2], "explicit") == 0) {
+            g = readGraphFromFileWithMode(words[1], GRAPH_EXPLICIT);
+        } else if (strcmp(words[2], "implicit") == 0) {
+            g = readGraphFromFileWithMode(words[1], GRAPH_IMPLICIT);
+        } else if (strcmp(words[2], "ranged") == 0 && count >= 4 && parseInts(words, 3, count - 3, v)) {
+            g = readGraphFromFileWithRange(words[1], v[0], count == 5 ? v[1] : 0);
+        } else {
+            return "usage: load <file> [explicit|implicit|ranged <radius> [nearest]]";
+        }
+        return replaceGraph(s, g) ? NULL : "could not read graph";
+    }
+    if (strcmp(name, "loadbin") == 0) {
+        if (count != 2) return "usage: loadbin <file>";
+        return replaceGraph(s, readGraphFromBinary(words[1])) ? NULL : "could not read graph";
+    }
+
+    // Os restantes comandos precisam de um grafo
+    bool known = strcmp(name, "save") == 0 || strcmp(name, "reload") == 0 || strcmp(name, "print") == 0 || strcmp(name, "stats") == 0
+        || strcmp(name, "add") == 0 || strcmp(name, "remove") == 0 || strcmp(name, "move") == 0
+        || strcmp(name, "dfs") == 0 || strcmp(name, "bfs") == 0 || strcmp(name, "paths") == 0
+        || strcmp(name, "intersect") == 0 || strcmp(name, "effects") == 0;
+    if (!known) return "unknown command";
+    if (s->g == NULL) return "no graph loaded";
+
+    if (strcmp(name, "save") == 0) {
+        if (count != 2) return "usage: save <file>";
+        writeGraphToBinary(words[1], s->g);
+    } else if (strcmp(name, "reload") == 0) {
+        if (count != 2) return "usage: reload <file>";
+        ReloadStats stats;
+        if (!reloadGraphFromFile(s->g, words[1], &stats)) return "could not read file";
+        char line[160];
+        snprintf(line, sizeof(line), "Reloaded: %d added, %d removed, %d changed (%d rows unchanged)\n",
+                 stats.added, stats.removed, stats.changed, stats.rowsSkipped);
+        writeText(s->out, line);
+    } else if (strcmp(name, "print") == 0) {
+        writeGraph(s->out, s->g);
+    } else if (strcmp(name, "stats") == 0) {
+        writeStats(s);
+    } else if (strcmp(name, "add") == 0) {
+        if (count != 4 || !parseInts(words, 1, 2, v) || !parseFrequency(words[3], &f)) return "usage: add <x> <y> <f>";
+        if (findVertex(s->g, v[0], v[1], f) != NULL) return "antenna already exists";
+        int before = s->g->vertexCount;
+        addVertex(s->g, v[0], v[1], f);
+        if (s->g->vertexCount == before) return "out of memory";
+    } else if (strcmp(name, "remove") == 0) {
+        if (count != 4 || !parseInts(words, 1, 2, v) || !parseFrequency(words[3], &f)) return "usage: remove <x> <y> <f>";
+        if (!removeVertex(s->g, v[0], v[1], f)) return "antenna not found";
+    } else if (strcmp(name, "move") == 0) {
+        if (count != 6 || !parseInts(words, 1, 2, v) || !parseFrequency(words[3], &f) || !parseInts(words, 4, 2, v + 2)) {
+            return "usage: move <x> <y> <f> <newX> <newY>";
+        }
+        if (!moveVertex(s->g, v[0], v[1], f, v[2], v[3])) return "antenna not found or destination taken";
+    } else if (strcmp(name, "dfs") == 0 || strcmp(name, "bfs") == 0) {
+        if (count != 4 || !parseInts(words, 1, 2, v) || !parseFrequency(words[3], &f)) return "usage: dfs|bfs <x> <y> <f>";
+        bool ok = name[0] == 'd' ? writeDepthFirstSearch(s->out, s->g, s->ctx, v[0], v[1], f)
+                                 : writeBreadthFirstSearch(s->out, s->g, s->ctx, v[0], v[1], f);
+        if (!ok) return "antenna not found";
+    } else if (strcmp(name, "paths") == 0) {
+        v[4] = v[5] = 0;
+        if (count < 6 || count > 8 || !parseInts(words, 1, 4, v) || !parseFrequency(words[5], &f)
+            || !parseInts(words, 6, count - 6, v + 4)) {
+            return "usage: paths <x1> <y1> <x2> <y2> <f> [maxLength] [maxResults]";
+        }
+        if (writePaths(s->out, s->g, s->ctx, v[0], v[1], v[2], v[3], f, v[4], v[5]) < 0) return "antenna not found";
+    } else if (strcmp(name, "intersect") == 0) {
+        if (count != 3 || !parseFrequency(words[1], &f) || !parseFrequency(words[2], &fB)) return "usage: intersect <fA> <fB>";
+        writeIntersections(s->out, s->g, f, fB);
+    } else {
+        InterferenceMap *effects = computeInterference(s->g, 0);
+        if (effects == NULL) return "out of memory";
+        writeInterference(s->out, effects);
+        freeInterferenceMap(effects);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Executa os comandos de um script sobre um único grafo carregado
+ * 
+ * Depois de cada comando os resultados são enviados para o stdout e o tempo do comando
+ * é escrito no stderr. Um comando com erro é reportado e o script continua.
+ * 
+ * @param in Ficheiro com os comandos
+ * @return int 0 se todos os comandos foram executados, 1 se algum falhou
+ */
+static int runScript(FILE *in) {
+    Session s = { createOutputWriter(stdout, OUTPUT_TEXT), OUTPUT_TEXT, NULL, createTraversalContext() };
+    if (s.out == NULL || s.ctx == NULL) {
+        freeOutputWriter(s.out);
+        freeTraversalContext(s.ctx);
+        return 1;
+    }
+
+    int status = 0;
+    char *line = NULL;
+    size_t len = 0;
+    int lineNumber = 0;
+    bool quit = false;
+    while (!quit && getline(&line, &len, in) != -1) {
+        lineNumber++;
+        char *words[MAX_WORDS];
+        int count = 0;
+        for (char *word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+            if (count == MAX_WORDS) {
+                count++;
+                break;
+            }
+            words[count++] = word;
+        }
+        if (count == 0 || words[0][0] == '#') continue;
+
+        long long start = nowNs();
+        const char *error = count > MAX_WORDS ? "too many arguments" : runCommand(&s, words, count, &quit);
+        bool written = flushOutputWriter(s.out);
+        long long elapsed = nowNs() - start;
+
+        if (error != NULL) {
+            fprintf(stderr, "Error on line %d (%s): %s\n", lineNumber, words[0], error);
+            status = 1;
+        } else {
+            fprintf(stderr, "%s: %.3f ms\n", words[0], elapsed / 1e6);
+        }
+        if (!written) {
+            status = 1;
+            break;
+        }
+    }
+
+    free(line);
+    freeTraversalContext(s.ctx);
+    freeGraph(s.g);
+    return freeOutputWriter(s.out) ? status : 1;
+}
+
+/**
+ * @brief Demonstração sobre data/antennasFile1.txt (execução sem argumentos)
+ * 
+ * @return int 0 se todas as escritas tiveram sucesso
+ */
+static int runDemo(void) {
+    // Todos os resultados passam pelo mesmo escritor com buffer
+    OutputWriter *out = createOutputWriter(stdout, OUTPUT_TEXT);
+    if (out == NULL) {
+        return 1;
+    }
+
     Graph *g = NULL;  // Declara e inicializa como NULL
     g = readGraphFromFile("data/antennasFile1.txt"); 
 
     if (g == NULL) {
-        printf("Antenna matrix is empty after reading from text file\n");
+        writeText(out, "Antenna matrix is empty after reading from text file\n");
     } else {
-        printGraph(g);
-        printf("\n");
+        TraversalContext *ctx = createTraversalContext();
+
+        writeGraph(out, g);
+        writeText(out, "\n");
 
-        printf("dFS from vertex (1, 1) [B]:\n");
-        depthFirstSearch(g, 1, 1, 'B');
-        printf("\n");
+        writeText(out, "dFS from vertex (1, 1) [B]:\n");
+        writeDepthFirstSearch(out, g, ctx, 1, 1, 'B');
+        writeText(out, "\n");
 
-        printf("bFS from vertex  (1, 1) [B]:\n");
-        breadthFirstSearch(g, 1, 1, 'B');
-        printf("\n");
+        writeText(out, "bFS from vertex  (1, 1) [B]:\n");
+        writeBreadthFirstSearch(out, g, ctx, 1, 1, 'B');
+        writeText(out, "\n");
 
-        printf("Find all paths from (1, 1) [B] and (3, 7) [B]:\n");
-        findAllPaths(g, 1, 1, 3, 7, 'B');
-        printf("\n");
+        writeText(out, "Find all paths from (1, 1) [B] and (3, 7) [B]:\n");
+        writePaths(out, g, ctx, 1, 1, 3, 7, 'B', 0, 0);
+        writeText(out, "\n");
         
-        printf("Intersections between frequency A and B:\n");
-        listIntersectionsBetweenFrequencies(g, 'A', 'B');
-        printf("\n");
+        writeText(out, "Intersections between frequency A and B:\n");
+        writeIntersections(out, g, 'A', 'B');
+        writeText(out, "\n");
+
+        writeText(out, "Nefarious effect locations:\n");
+        InterferenceMap *effects = computeInterference(g, 0);
+        if (effects == NULL) {
+            writeText(out, "Error computing nefarious effect locations\n");
+        } else {
+            char total[64];
+            writeInterference(out, effects);
+            snprintf(total, sizeof(total), "Total: %lld\n", effects->count);
+            writeText(out, total);
+            freeInterferenceMap(effects);
+        }
+        writeText(out, "\n");
+
+        freeTraversalContext(ctx);
         
         // Guardar o grafo em ficheiro binário
         writeGraphToBinary("data/antennas.bin", g);
-            printf("Antennas graphs successfully saved to antennas.bin\n");
+            writeText(out, "Antennas graphs successfully saved to antennas.bin\n");
     
         // Ler novamente o grafo do ficheiro binário
         Graph *gFromBin = readGraphFromBinary("data/antennas.bin");
         if (gFromBin == NULL) {
-            printf("Error reading Antennas Graphs from binary file\n");
+            writeText(out, "Error reading Antennas Graphs from binary file\n");
         } else {
-            printf("Antennas Graphs successfully read from binary file\n");
-            printGraph(gFromBin);
+            writeText(out, "Antennas Graphs successfully read from binary file\n");
+            writeGraph(out, gFromBin);
             freeGraph(gFromBin);
         }  
     }   
     freeGraph(g); 
 
-    return 0;
+    return freeOutputWriter(out) ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) return runDemo();
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s [command file | -]\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "-") == 0) return runScript(stdin);
+    FILE *in = fopen(argv[1], "r");
+    if (in == NULL) {
+        fprintf(stderr, "Error opening %s\n", argv[1]);
+        return 1;
+    }
+    int status = runScript(in);
+    fclose(in);
+    return status;
 }
 
 